@@ -0,0 +1,145 @@
+#ifndef ASYNCTREEWRITER_H
+#define ASYNCTREEWRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Hands filled buffer sets to a background thread that runs the (tree filling) function on them,
+// so that the basket compression is taken off the event processing path. At most maxQueued sets
+// wait to be written at any time and written sets are recycled, so the number of buffer sets in
+// memory is bounded by the number of producers + maxQueued + 1.
+template<typename Buffers>
+class AsyncTreeWriter {
+
+  public :
+
+    typedef std::function<void (Buffers&)> FillFunction;
+    typedef std::function<Buffers* ()> MakeFunction;
+
+    // make allocates a new (empty) buffer set when no written one is free
+    AsyncTreeWriter(const FillFunction & fill, const MakeFunction & make, unsigned int maxQueued) :
+      fill_(fill),
+      make_(make),
+      maxQueued_(maxQueued>0 ? maxQueued : 1),
+      stopping_(false),
+      nAllocated_(0),
+      thread_(&AsyncTreeWriter::run, this)
+    {}
+
+    ~AsyncTreeWriter()
+    {
+      try { stop(); }
+      catch (...) {}
+    }
+
+    // queues a filled buffer set and returns a free one to be filled next (blocks while the queue is full)
+    std::unique_ptr<Buffers> push(std::unique_ptr<Buffers> filled)
+    {
+      std::unique_ptr<Buffers> next;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        rethrow();
+        notFull_.wait(lock, [this]() { return queue_.size() < maxQueued_ || exception_; });
+        rethrow();
+
+        queue_.push_back(std::move(filled));
+
+        if( !free_.empty() )
+        {
+          next = std::move(free_.back());
+          free_.pop_back();
+        }
+        else
+          ++nAllocated_;
+      }
+      notEmpty_.notify_one();
+
+      if( !next ) next.reset(make_());
+      return next;
+    }
+
+    // writes all queued buffer sets and stops the background thread (rethrows the first exception it caught)
+    void stop()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+      }
+      notEmpty_.notify_one();
+      if( thread_.joinable() ) thread_.join();
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      rethrow();
+    }
+
+    // number of buffer sets allocated on top of the ones handed in by the producers
+    unsigned int nAllocated() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return nAllocated_;
+    }
+
+  private :
+
+    void run()
+    {
+      for(;;)
+      {
+        std::unique_ptr<Buffers> buffers;
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          notEmpty_.wait(lock, [this]() { return !queue_.empty() || stopping_; });
+          if( queue_.empty() ) break;
+
+          buffers = std::move(queue_.front());
+          queue_.pop_front();
+        }
+
+        std::exception_ptr exception;
+        try { fill_(*buffers); }
+        catch (...) { exception = std::current_exception(); }
+
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if( exception && !exception_ ) exception_ = exception;
+          free_.push_back(std::move(buffers));
+        }
+        notFull_.notify_all();
+      }
+    }
+
+    // to be called with mutex_ held
+    void rethrow()
+    {
+      if( exception_ )
+      {
+        std::exception_ptr exception = exception_;
+        exception_ = std::exception_ptr();
+        std::rethrow_exception(exception);
+      }
+    }
+
+    FillFunction fill_;
+    MakeFunction make_;
+    const unsigned int maxQueued_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+
+    std::deque<std::unique_ptr<Buffers> > queue_;
+    std::vector<std::unique_ptr<Buffers> > free_;
+    std::exception_ptr exception_;
+    bool stopping_;
+    unsigned int nAllocated_;
+
+    std::thread thread_;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef BRANCHCOLUMN_H
+#define BRANCHCOLUMN_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <stdint.h>
+#include <string>
+
+#include <TBranch.h>
+#include <TLeaf.h>
+#include <TTree.h>
+
+// rounds a float to the given number of mantissa bits (out of 23) so that the low bits compress away;
+// infinities and NaNs are left untouched and values that would round up to infinity are truncated instead
+inline float TruncateMantissa(float value, int mantissaBits) {
+  if( mantissaBits < 0 || mantissaBits >= 23 ) return value;
+
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if( (bits & 0x7f800000u) == 0x7f800000u ) return value;
+
+  const uint32_t dropped = 23 - mantissaBits;
+  const uint32_t mask = ~((1u << dropped) - 1);
+  const uint32_t rounded = ( bits + (1u << (dropped-1)) ) & mask;
+  bits = ( (rounded & 0x7f800000u) == 0x7f800000u ? bits & mask : rounded );
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+inline void TruncateMantissa(float * data, size_t n, int mantissaBits) {
+  for( size_t i = 0; i < n; ++i ) data[i] = TruncateMantissa(data[i], mantissaBits);
+}
+
+// integer columns are always stored exactly
+inline void TruncateMantissa(int *, size_t, int) {}
+
+
+class BranchColumnBase {
+
+  public :
+
+    virtual ~BranchColumnBase() {}
+
+    // makes room for at least n entries
+    virtual void Fit(size_t n) = 0;
+
+    virtual void * Address() = 0;
+
+    virtual size_t Capacity() const = 0;
+
+    // reduces the precision of the first n entries, see TruncateMantissa
+    virtual void Truncate(size_t n, int mantissaBits) = 0;
+
+    // true if the column was reallocated since it was last bound to a branch
+    bool Moved() const { return bound_ && moved_; }
+
+    // largest number of entries the column had to hold
+    size_t HighWaterMark() const { return highWaterMark_; }
+
+    // creates the branch in the output tree
+    TBranch * Branch(TTree *tree, const std::string & name, const std::string & leaflist) {
+      TBranch * branch = tree->Branch(name.c_str(), Address(), leaflist.c_str());
+      bound_ = true;
+      moved_ = false;
+      return branch;
+    }
+
+    // points a branch created (by Branch) with another column of the same schema to this column
+    void Bind(TBranch *branch) {
+      branch->SetAddress(Address());
+      bound_ = true;
+      moved_ = false;
+    }
+
+    // points the branch of an existing tree to the column, after growing it to the largest length stored in the tree
+    void SetBranchAddress(TTree *tree, const std::string & name) {
+      TBranch * branch = tree->GetBranch(name.c_str());
+      TLeaf * leaf = ( branch ? static_cast<TLeaf*>(branch->GetListOfLeaves()->At(0)) : 0 );
+      if( leaf ) {
+        TLeaf * leafCount = leaf->GetLeafCount();
+        Fit( leafCount ? std::max(leafCount->GetMaximum(), 0) : leaf->GetLen() );
+      }
+      tree->SetBranchAddress(name.c_str(), Address());
+      bound_ = true;
+      moved_ = false;
+    }
+
+  protected :
+
+    BranchColumnBase() : bound_(false), moved_(false), highWaterMark_(0) {}
+
+    bool bound_;
+    bool moved_;
+    size_t highWaterMark_;
+};
+
+
+// contiguous, cache-line aligned column that grows on demand when an entry beyond its end is accessed.
+// A reallocation invalidates the address given to the tree, so the branches have to be bound again
+// (see BranchRegistry::Fit) before the next TTree::Fill or TTree::GetEntry.
+template<typename T>
+class BranchColumn : public BranchColumnBase {
+
+  public :
+
+    static const size_t alignment = 64;
+    static const size_t initialSize = 16;
+
+    BranchColumn() : data_(0), size_(0) {
+      Allocate(initialSize);
+    }
+
+    ~BranchColumn() { std::free(data_); }
+
+    // only reallocates (and therefore only writes to the column bookkeeping) when i is beyond the end
+    T & operator[](size_t i) {
+      if( i >= size_ ) Fit(i+1);
+      return data_[i];
+    }
+
+    const T & operator[](size_t i) const {
+      assert( i < size_ );
+      return data_[i];
+    }
+
+    T * data() { return data_; }
+    const T * data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    // copies a range of values starting at entry offset
+    template<typename Iterator>
+    void assign(size_t offset, Iterator begin, Iterator end) {
+      size_t n = std::distance(begin, end);
+      if( n == 0 ) return;
+      if( offset+n > size_ ) Fit(offset+n);
+      std::copy(begin, end, data_+offset);
+    }
+
+    virtual void Fit(size_t n) {
+      if( n > highWaterMark_ ) highWaterMark_ = n;
+      if( n <= size_ ) return;
+
+      Allocate( std::max(n, 2*size_) );
+    }
+
+    virtual void * Address() { return data_; }
+
+    virtual size_t Capacity() const { return size_*sizeof(T); }
+
+    virtual void Truncate(size_t n, int mantissaBits) { TruncateMantissa(data_, std::min(n, size_), mantissaBits); }
+
+  private :
+
+    BranchColumn(const BranchColumn&);
+    BranchColumn & operator=(const BranchColumn&);
+
+    void Allocate(size_t n) {
+      void * data = 0;
+      if( posix_memalign(&data, alignment, n*sizeof(T)) != 0 ) throw std::bad_alloc();
+
+      std::memset(data, 0, n*sizeof(T));
+      if( data_ ) std::memcpy(data, data_, size_*sizeof(T));
+      std::free(data_);
+
+      data_ = static_cast<T*>(data);
+      size_ = n;
+      moved_ = true;
+    }
+
+    T * data_;
+    size_t size_;
+};
+
+#endif
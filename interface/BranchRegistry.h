@@ -0,0 +1,220 @@
+#ifndef BRANCHREGISTRY_H
+#define BRANCHREGISTRY_H
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <TBranch.h>
+#include <TTree.h>
+
+#include "RecoBTag/BTagAnalyzerLite/interface/BranchColumn.h"
+
+// ROOT leaf type codes
+template<typename T> struct BranchLeafType;
+template<> struct BranchLeafType<int>   { static char code() { return 'I'; } };
+template<> struct BranchLeafType<float> { static char code() { return 'F'; } };
+
+// one branch of a set of branches: either a single value (scalar) or a column whose length is given by a counter
+struct BranchEntry {
+  std::string name;
+  std::string counter;   // empty for scalars
+  char        type;      // ROOT leaf type code
+  int         group;     // Register*/Read* group the branch belongs to
+  void *             scalar;
+  BranchColumnBase * column;
+  const int *        count;
+  bool               keep;     // false if the branch was dropped by the branch selection
+  TBranch *          branch;   // set when the branch is created
+
+  bool IsColumn() const { return column != 0; }
+};
+
+// output tree(s) of a set of branches: a single tree, or separate trees for the columns of given counters
+// (together with the counter itself) and the main tree for everything else
+class BranchTrees {
+
+  public :
+
+    BranchTrees(TTree *tree=0) : main_(tree) {}
+
+    void Add(const std::string & counter, TTree *tree) { byCounter_[counter] = tree; }
+
+    TTree * Main() const { return main_; }
+
+    TTree * operator()(const BranchEntry & entry) const {
+      std::map<std::string,TTree*>::const_iterator it = byCounter_.find( entry.IsColumn() ? entry.counter : entry.name );
+      return ( it != byCounter_.end() ? it->second : main_ );
+    }
+
+  private :
+
+    TTree * main_;
+    std::map<std::string,TTree*> byCounter_;
+};
+
+// runtime description of a set of branches, filled from the branch schema of EventInfoBranches/JetInfoBranches
+// (and possibly extended at run time); it creates and binds the branches and keeps the columns sized to their counters
+class BranchRegistry {
+
+  public :
+
+    BranchRegistry() {}
+
+    template<typename T>
+    void AddScalar(const std::string & name, T * scalar, int group) {
+      BranchEntry entry = { name, "", BranchLeafType<T>::code(), group, scalar, 0, 0, true, 0 };
+      entries_.push_back(entry);
+    }
+
+    template<typename T>
+    void AddColumn(const std::string & name, BranchColumn<T> * column, const std::string & counter, const int * count, int group) {
+      BranchEntry entry = { name, counter, BranchLeafType<T>::code(), group, 0, column, count, true, 0 };
+      entries_.push_back(entry);
+    }
+
+    const std::vector<BranchEntry> & Entries() const { return entries_; }
+
+    const BranchEntry * Find(const std::string & name) const {
+      for( std::vector<BranchEntry>::const_iterator it = entries_.begin(); it != entries_.end(); ++it )
+        if( it->name == name ) return &(*it);
+      return 0;
+    }
+
+    // true if the branch was created by Register
+    bool Stored(const std::string & name) const {
+      const BranchEntry * entry = Find(name);
+      return ( entry && entry->branch );
+    }
+
+    // applies a branch selection (keep(branch name) returns false for dropped branches) to the following Register calls;
+    // the counters of the kept columns are always kept
+    template<typename Keep>
+    void Select(const Keep & keep, const std::string & prefix) {
+      for( std::vector<BranchEntry>::iterator it = entries_.begin(); it != entries_.end(); ++it )
+        it->keep = keep(prefix + it->name);
+
+      for( std::vector<BranchEntry>::iterator it = entries_.begin(); it != entries_.end(); ++it ) {
+        if( !it->IsColumn() || !it->keep ) continue;
+
+        for( std::vector<BranchEntry>::iterator counter = entries_.begin(); counter != entries_.end(); ++counter )
+          if( counter->name == it->counter ) counter->keep = true;
+      }
+    }
+
+    // number of mantissa bits to store for each entry (-1 for full precision) given precision(branch name),
+    // to be passed to Truncate; only float branches are affected
+    template<typename Precision>
+    std::vector<int> MantissaBits(const Precision & precision, const std::string & prefix) const {
+      std::vector<int> mantissaBits(entries_.size(), -1);
+      for( size_t i = 0; i < entries_.size(); ++i )
+        if( entries_[i].type == BranchLeafType<float>::code() && entries_[i].keep ) mantissaBits[i] = precision(prefix + entries_[i].name);
+      return mantissaBits;
+    }
+
+    // reduces the precision of the current values before they are written
+    void Truncate(const std::vector<int> & mantissaBits) {
+      for( size_t i = 0; i < entries_.size() && i < mantissaBits.size(); ++i ) {
+        if( mantissaBits[i] < 0 ) continue;
+
+        BranchEntry & entry = entries_[i];
+        if( entry.IsColumn() )
+          entry.column->Truncate( std::max(*entry.count, 0), mantissaBits[i] );
+        else if( entry.type == BranchLeafType<float>::code() )
+          *static_cast<float*>(entry.scalar) = TruncateMantissa( *static_cast<float*>(entry.scalar), mantissaBits[i] );
+      }
+    }
+
+    // creates the (kept) branches of a group, prefix is prepended to the branch and counter names
+    void Register(const BranchTrees & trees, const std::string & prefix, int group) {
+      for( std::vector<BranchEntry>::iterator it = entries_.begin(); it != entries_.end(); ++it ) {
+        if( it->group != group || !it->keep ) continue;
+
+        TTree * tree = trees(*it);
+        const std::string name = prefix + it->name;
+        if( it->IsColumn() )
+          it->branch = it->column->Branch(tree, name, name + "[" + prefix + it->counter + "]/" + it->type);
+        else
+          it->branch = tree->Branch(name.c_str(), it->scalar, (name + "/" + it->type).c_str());
+      }
+    }
+
+    // branch of each entry created by Register (0 for the entries without a branch), in the order of Entries()
+    std::vector<TBranch*> Branches() const {
+      std::vector<TBranch*> branches;
+      for( std::vector<BranchEntry>::const_iterator it = entries_.begin(); it != entries_.end(); ++it )
+        branches.push_back(it->branch);
+      return branches;
+    }
+
+    // points output branches (Branches() of a registry with the same schema, e.g. the one the branches were created
+    // with) to this set of buffers, without looking the branches up by name
+    void Bind(const std::vector<TBranch*> & branches) {
+      for( size_t i = 0; i < entries_.size() && i < branches.size(); ++i ) {
+        if( !branches[i] ) continue;
+
+        if( entries_[i].IsColumn() )
+          entries_[i].column->Bind(branches[i]);
+        else
+          branches[i]->SetAddress(entries_[i].scalar);
+      }
+    }
+
+    // points the branches of a group to this set of buffers (branches missing from the tree, e.g. dropped ones, are skipped)
+    void Read(const BranchTrees & trees, const std::string & prefix, int group) {
+      for( std::vector<BranchEntry>::iterator it = entries_.begin(); it != entries_.end(); ++it ) {
+        if( it->group != group ) continue;
+
+        TTree * tree = trees(*it);
+        const std::string name = prefix + it->name;
+        if( !tree->GetBranch(name.c_str()) ) continue;
+        if( it->IsColumn() )
+          it->column->SetBranchAddress(tree, name);
+        else
+          tree->SetBranchAddress(name.c_str(), it->scalar);
+      }
+    }
+
+    // grows every column to the current value of its counter, returns true if a column bound to a branch was reallocated
+    bool Fit() {
+      bool moved = false;
+      for( std::vector<BranchEntry>::iterator it = entries_.begin(); it != entries_.end(); ++it ) {
+        if( !it->IsColumn() ) continue;
+
+        it->column->Fit( std::max(*it->count, 0) );
+        moved |= it->column->Moved();
+      }
+      return moved;
+    }
+
+    // memory currently allocated for the columns
+    size_t Capacity() const {
+      size_t capacity = 0;
+      for( std::vector<BranchEntry>::const_iterator it = entries_.begin(); it != entries_.end(); ++it )
+        if( it->IsColumn() ) capacity += it->column->Capacity();
+      return capacity;
+    }
+
+    // counters of the columns, in the order they appear
+    std::vector<std::pair<std::string,const int*> > Counters() const {
+      std::vector<std::pair<std::string,const int*> > counters;
+      for( std::vector<BranchEntry>::const_iterator it = entries_.begin(); it != entries_.end(); ++it ) {
+        if( !it->IsColumn() ) continue;
+
+        std::pair<std::string,const int*> counter(it->counter, it->count);
+        if( std::find(counters.begin(), counters.end(), counter) == counters.end() ) counters.push_back(counter);
+      }
+      return counters;
+    }
+
+  private :
+
+    BranchRegistry(const BranchRegistry&);
+    BranchRegistry & operator=(const BranchRegistry&);
+
+    std::vector<BranchEntry> entries_;
+};
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef DELTARMATCHER_H
+#define DELTARMATCHER_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "DataFormats/Math/interface/deltaR.h"
+
+// Greedy Delta R matching of queries to a set of targets (e.g. groomed to original fat jets, subjets or leptons to jets):
+// each query in turn takes the closest target (in eta or rapidity and phi) that was not taken before, the target with the
+// lowest index winning ties. The targets are kept in an eta-phi grid so that a query only looks at the cells around it,
+// moving outwards until no unvisited cell can hold a closer target, instead of going through all the targets.
+class DeltaRMatcher {
+
+  public :
+
+    // cellSize should be of the order of the typical matching distance (e.g. the jet size parameter)
+    explicit DeltaRMatcher(double cellSize) : cellSize_(cellSize), built_(false), nFree_(0), stamp_(0) {}
+
+    // adds a target, the targets are numbered in the order they are added
+    int Add(double eta, double phi) {
+      Target target = { eta, phi, false };
+      targets_.push_back(target);
+      built_ = false;
+      ++nFree_;
+      return targets_.size() - 1;
+    }
+
+    void Clear() {
+      targets_.clear();
+      built_ = false;
+      nFree_ = 0;
+    }
+
+    size_t Size() const { return targets_.size(); }
+
+    // closest free target within maxDR2 (Delta R squared), -1 if there is none
+    int Nearest(double eta, double phi, double maxDR2 = std::numeric_limits<double>::infinity()) {
+      if( nFree_ == 0 ) return -1;
+      if( !built_ ) Build();
+
+      const int iEta = EtaCell(eta);
+      const int iPhi = PhiCell(phi);
+      ++stamp_;
+
+      int nearest = -1;
+      double nearestDR2 = maxDR2;
+      const int maxRing = std::max(nEta_, nPhi_);
+      for( int ring = 0; ring <= maxRing; ++ring ) {
+        // every cell outside of the rings visited so far is at least (ring-1) cells away
+        if( ring > 0 ) {
+          const double bound = (ring-1)*cellSize_;
+          if( nearest >= 0 ? bound*bound > nearestDR2 : bound*bound > maxDR2 ) break;
+        }
+
+        for( int dEta = -ring; dEta <= ring; ++dEta ) {
+          const int e = iEta + dEta;
+          if( e < 0 || e >= nEta_ ) continue;
+
+          const bool edge = ( dEta == -ring || dEta == ring );
+          for( int dPhi = -ring; dPhi <= ring; dPhi += ( edge ? 1 : 2*std::max(ring,1) ) ) {
+            const int p = ( (iPhi + dPhi) % nPhi_ + nPhi_ ) % nPhi_;
+            const int cell = e*nPhi_ + p;
+            if( cellStamps_[cell] == stamp_ ) continue;
+            cellStamps_[cell] = stamp_;
+
+            for( std::vector<int>::const_iterator it = cells_[cell].begin(); it != cells_[cell].end(); ++it ) {
+              const double dR2 = reco::deltaR2(eta, phi, targets_[*it].eta, targets_[*it].phi);
+              if( dR2 < nearestDR2 || ( dR2 == nearestDR2 && ( nearest < 0 ? dR2 <= maxDR2 : *it < nearest ) ) ) {
+                nearest = *it;
+                nearestDR2 = dR2;
+              }
+            }
+          }
+        }
+      }
+      return nearest;
+    }
+
+    // marks a target as taken, it is not returned by the following queries
+    void Take(int i) {
+      if( targets_[i].taken ) return;
+      targets_[i].taken = true;
+      --nFree_;
+      if( !built_ ) return;
+
+      std::vector<int> & cell = cells_[ EtaCell(targets_[i].eta)*nPhi_ + PhiCell(targets_[i].phi) ];
+      cell.erase( std::find(cell.begin(), cell.end(), i) );
+    }
+
+    // takes and returns the closest free target, -1 if there is none within maxDR2
+    int Match(double eta, double phi, double maxDR2 = std::numeric_limits<double>::infinity()) {
+      const int i = Nearest(eta, phi, maxDR2);
+      if( i >= 0 ) Take(i);
+      return i;
+    }
+
+  private :
+
+    struct Target {
+      double eta, phi;
+      bool taken;
+    };
+
+    void Build() {
+      etaMin_ = std::numeric_limits<double>::infinity();
+      double etaMax = -etaMin_;
+      for( std::vector<Target>::const_iterator it = targets_.begin(); it != targets_.end(); ++it ) {
+        etaMin_ = std::min(etaMin_, it->eta);
+        etaMax  = std::max(etaMax, it->eta);
+      }
+      if( !(etaMax >= etaMin_) ) etaMin_ = etaMax = 0.;
+
+      nEta_ = int( (etaMax - etaMin_)/cellSize_ ) + 1;
+      // the phi cells are at least cellSize wide so that the ring bound above holds
+      nPhi_ = std::max( int( 2*M_PI/cellSize_ ), 1 );
+
+      cells_.assign(nEta_*nPhi_, std::vector<int>());
+      cellStamps_.assign(nEta_*nPhi_, 0);
+      stamp_ = 0;
+      for( size_t i = 0; i < targets_.size(); ++i )
+        if( !targets_[i].taken ) cells_[ EtaCell(targets_[i].eta)*nPhi_ + PhiCell(targets_[i].phi) ].push_back(i);
+      built_ = true;
+    }
+
+    int EtaCell(double eta) const {
+      const int i = int( std::floor( (eta - etaMin_)/cellSize_ ) );
+      return std::min( std::max(i, 0), nEta_-1 );
+    }
+
+    int PhiCell(double phi) const {
+      const double x = ( reco::deltaPhi(phi, 0.) + M_PI )/( 2*M_PI );
+      return std::min( std::max( int( x*nPhi_ ), 0 ), nPhi_-1 );
+    }
+
+    const double cellSize_;
+    std::vector<Target> targets_;
+    bool built_;
+    int nFree_;
+
+    double etaMin_;
+    int nEta_, nPhi_;
+    std::vector<std::vector<int> > cells_;
+    std::vector<unsigned int> cellStamps_;
+    unsigned int stamp_;
+};
+
+#endif
@@ -1,211 +1,146 @@
 #ifndef EVENTINFOBRANCHES_H
 #define EVENTINFOBRANCHES_H
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <TTree.h>
 
-const UInt_t nMaxPVs_= 1000;
-const UInt_t nMaxPUs_= 1000;
-const UInt_t nMaxTrkAll_ = 100000;
+#include "RecoBTag/BTagAnalyzerLite/interface/BranchRegistry.h"
+
+// Branch schema: every branch appears once, in the order the branches are created, as
+//   SCALAR(type, name, group)           a single value
+//   COLUMN(type, name, counter, group)  one value per entry, the number of entries is given by the counter
+// The members, the Register*/Read* functions and the BranchRegistry used at run time are generated from it.
+#define EVENTINFO_BRANCHES(SCALAR, COLUMN) \
+  SCALAR(int,   nBitTrigger,                    Tree        )                                                                                                                     \
+  COLUMN(int,   BitTrigger,       nBitTrigger,  Tree        )                                                                                                                     \
+  SCALAR(int,   Run,                            Tree        )                                                                                                                     \
+  SCALAR(int,   Evt,                            Tree        )                                                                                                                     \
+  SCALAR(int,   LumiBlock,                      Tree        )                                                                                                                     \
+  SCALAR(float, pthat,                          Tree        )                                                                                                                     \
+  SCALAR(float, mcweight,                       Tree        )                                                                                                                     \
+  SCALAR(int,   nPV,                            Tree        )                                                                                                                     \
+  SCALAR(float, PVz,                            Tree        )                                                                                                                     \
+  SCALAR(float, PVez,                           Tree        )                                                                                                                     \
+  SCALAR(float, GenPVz,                         Tree        )                                                                                                                     \
+  SCALAR(float, nPUtrue,                        Tree        ) /* the true number of pileup interactions that have been added to the event */                                      \
+  SCALAR(int,   nPU,                            Tree        ) /* the number of pileup interactions that have been added to the event */                                           \
+  COLUMN(int,   PU_bunch,         nPU,          Tree        ) /* 0 if on time pileup, -1 or +1 if out-of-time */                                                                  \
+  COLUMN(float, PU_z,             nPU,          Tree        ) /* the true primary vertex position along the z axis for each added interaction */                                  \
+  COLUMN(float, PU_sumpT_low,     nPU,          Tree        ) /* the sum of the transverse momentum of the tracks originating from each interaction, where track pT > low_cut */  \
+  COLUMN(float, PU_sumpT_high,    nPU,          Tree        ) /* the sum of the transverse momentum of the tracks originating from each interaction, where track pT > high_cut */ \
+  COLUMN(int,   PU_ntrks_low,     nPU,          Tree        ) /* the number of tracks originating from each interaction, where track pT > low_cu */                               \
+  COLUMN(int,   PU_ntrks_high,    nPU,          Tree        ) /* the number of tracks originating from each interaction, where track pT > high_cut */                             \
+  SCALAR(int,   nGenPruned,                     Tree        )                                                                                                                     \
+  COLUMN(float, GenPruned_pT,     nGenPruned,   Tree        )                                                                                                                     \
+  COLUMN(float, GenPruned_eta,    nGenPruned,   Tree        )                                                                                                                     \
+  COLUMN(float, GenPruned_phi,    nGenPruned,   Tree        )                                                                                                                     \
+  COLUMN(float, GenPruned_mass,   nGenPruned,   Tree        )                                                                                                                     \
+  COLUMN(int,   GenPruned_pdgID,  nGenPruned,   Tree        )                                                                                                                     \
+  COLUMN(int,   GenPruned_status, nGenPruned,   Tree        )                                                                                                                     \
+  COLUMN(int,   GenPruned_mother, nGenPruned,   Tree        )                                                                                                                     \
+  COLUMN(float, PV_x,             nPV,          JetTrackTree)                                                                                                                     \
+  COLUMN(float, PV_y,             nPV,          JetTrackTree)                                                                                                                     \
+  COLUMN(float, PV_z,             nPV,          JetTrackTree)                                                                                                                     \
+  COLUMN(float, PV_ex,            nPV,          JetTrackTree)                                                                                                                     \
+  COLUMN(float, PV_ey,            nPV,          JetTrackTree)                                                                                                                     \
+  COLUMN(float, PV_ez,            nPV,          JetTrackTree)                                                                                                                     \
+  COLUMN(float, PV_chi2,          nPV,          JetTrackTree)                                                                                                                     \
+  COLUMN(float, PV_ndf,           nPV,          JetTrackTree)                                                                                                                     \
+  COLUMN(int,   PV_isgood,        nPV,          JetTrackTree)                                                                                                                     \
+  COLUMN(int,   PV_isfake,        nPV,          JetTrackTree)                                                                                                                     \
+  SCALAR(int,   nMuon,                          MuonTree    )                                                                                                                     \
+  COLUMN(int,   Muon_nMuHit,      nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(int,   Muon_nTkHit,      nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(int,   Muon_nPixHit,     nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(int,   Muon_nOutHit,     nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(int,   Muon_isGlobal,    nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(int,   Muon_isPF,        nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(int,   Muon_nMatched,    nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_chi2,        nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_chi2Tk,      nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_pt,          nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_eta,         nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_phi,         nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_vz,          nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_IP,          nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_IPsig,       nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_IP2D,        nMuon,        MuonTree    )                                                                                                                     \
+  COLUMN(float, Muon_IP2Dsig,     nMuon,        MuonTree    )
 
 class EventInfoBranches {
 
   public :
 
-    int   nBitTrigger;
-    int   BitTrigger[100];
-    int   Run;
-    int   Evt;
-    int   LumiBlock;
-    float PVz;
-    float PVez;
-    float GenPVz;
-    float pthat;
-    float mcweight;
-
-    int   nPV;
-    float PV_x[nMaxPVs_];
-    float PV_y[nMaxPVs_];
-    float PV_z[nMaxPVs_];
-    float PV_ex[nMaxPVs_];
-    float PV_ey[nMaxPVs_];
-    float PV_ez[nMaxPVs_];
-    float PV_chi2[nMaxPVs_];
-    float PV_ndf[nMaxPVs_];
-    int   PV_isgood[nMaxPVs_];
-    int   PV_isfake[nMaxPVs_];
-
-    float nPUtrue;                 // the true number of pileup interactions that have been added to the event
-    int   nPU;                     // the number of pileup interactions that have been added to the event
-    int   PU_bunch[nMaxPUs_];      // 0 if on time pileup, -1 or +1 if out-of-time
-    float PU_z[nMaxPUs_];          // the true primary vertex position along the z axis for each added interaction
-    float PU_sumpT_low[nMaxPUs_];  // the sum of the transverse momentum of the tracks originating from each interaction, where track pT > low_cut
-    float PU_sumpT_high[nMaxPUs_]; // the sum of the transverse momentum of the tracks originating from each interaction, where track pT > high_cut
-    int   PU_ntrks_low[nMaxPUs_];  // the number of tracks originating from each interaction, where track pT > low_cu
-    int   PU_ntrks_high[nMaxPUs_]; // the number of tracks originating from each interaction, where track pT > high_cut
-
-    int   nGenPruned;
-    float GenPruned_pT[1000];
-    float GenPruned_eta[1000];
-    float GenPruned_phi[1000];
-    float GenPruned_mass[1000];
-    int   GenPruned_status[1000];
-    int   GenPruned_pdgID[1000];
-    int   GenPruned_mother[1000];
-
-    int   nMuon;
-    int   Muon_isGlobal[1000];
-    int   Muon_isPF[1000];
-    int   Muon_nTkHit[1000];
-    int   Muon_nPixHit[1000];
-    int   Muon_nOutHit[1000];
-    int   Muon_nMuHit[1000];
-    int   Muon_nMatched[1000];
-    float Muon_chi2[1000];
-    float Muon_chi2Tk[1000];
-    float Muon_pt[1000];
-    float Muon_eta[1000];
-    float Muon_phi[1000];
-    float Muon_vz[1000];
-    float Muon_IP[1000];
-    float Muon_IPsig[1000];
-    float Muon_IP2D[1000];
-    float Muon_IP2Dsig[1000];
-
-
-    void RegisterTree(TTree *tree) {
-      tree->Branch("nBitTrigger", &nBitTrigger,  "nBitTrigger/I");
-      tree->Branch("BitTrigger" , BitTrigger  ,  "BitTrigger[nBitTrigger]/I");
-      tree->Branch("Run"        , &Run        ,  "Run/I");
-      tree->Branch("Evt"        , &Evt        ,  "Evt/I");
-      tree->Branch("LumiBlock"  , &LumiBlock  ,  "LumiBlock/I");
-      tree->Branch("pthat"      , &pthat      ,  "pthat/F");
-      tree->Branch("mcweight"   , &mcweight   ,  "mcweight/F");
-      tree->Branch("nPV"        , &nPV        ,  "nPV/I");
-      tree->Branch("PVz"        , &PVz        ,  "PVz/F");
-      tree->Branch("PVez"       , &PVez       ,  "PVez/F");
-      tree->Branch("GenPVz"     , &GenPVz     ,  "GenPVz/F");
-
-      tree->Branch("nPUtrue"      , &nPUtrue     , "nPUtrue/F");
-      tree->Branch("nPU"          , &nPU         , "nPU/I"    );
-      tree->Branch("PU_bunch"     , PU_bunch     , "PU_bunch[nPU]/I");
-      tree->Branch("PU_z"         , PU_z         , "PU_z[nPU]/F");
-      tree->Branch("PU_sumpT_low" , PU_sumpT_low , "PU_sumpT_low[nPU]/F");
-      tree->Branch("PU_sumpT_high", PU_sumpT_high, "PU_sumpT_high[nPU]/F");
-      tree->Branch("PU_ntrks_low" , PU_ntrks_low , "PU_ntrks_low[nPU]/I");
-      tree->Branch("PU_ntrks_high", PU_ntrks_high, "PU_ntrks_high[nPU]/I");
-
-      tree->Branch("nGenPruned",     &nGenPruned       ,"nGenPruned/I");
-      tree->Branch("GenPruned_pT",     GenPruned_pT    , "GenPruned_pT[nGenPruned]/F");
-      tree->Branch("GenPruned_eta",    GenPruned_eta   , "GenPruned_eta[nGenPruned]/F");
-      tree->Branch("GenPruned_phi",    GenPruned_phi   , "GenPruned_phi[nGenPruned]/F");
-      tree->Branch("GenPruned_mass",    GenPruned_mass   , "GenPruned_mass[nGenPruned]/F");
-      tree->Branch("GenPruned_pdgID",  GenPruned_pdgID , "GenPruned_pdgID[nGenPruned]/I");
-      tree->Branch("GenPruned_status", GenPruned_status, "GenPruned_status[nGenPruned]/I");
-      tree->Branch("GenPruned_mother", GenPruned_mother, "GenPruned_mother[nGenPruned]/I");
+    // groups of branches registered together
+    enum Group { Tree, JetTrackTree, MuonTree };
+
+#define EVENTINFO_DECLARE_SCALAR(type, name, group)          type name;
+#define EVENTINFO_DECLARE_COLUMN(type, name, counter, group) BranchColumn<type> name;
+    EVENTINFO_BRANCHES(EVENTINFO_DECLARE_SCALAR, EVENTINFO_DECLARE_COLUMN)
+#undef EVENTINFO_DECLARE_SCALAR
+#undef EVENTINFO_DECLARE_COLUMN
+
+    EventInfoBranches() {
+#define EVENTINFO_ADD_SCALAR(type, name, group)          name = type(); registry_.AddScalar(#name, &name, group);
+#define EVENTINFO_ADD_COLUMN(type, name, counter, group) registry_.AddColumn(#name, &name, #counter, &counter, group);
+      EVENTINFO_BRANCHES(EVENTINFO_ADD_SCALAR, EVENTINFO_ADD_COLUMN)
+#undef EVENTINFO_ADD_SCALAR
+#undef EVENTINFO_ADD_COLUMN
     }
 
-    void RegisterJetTrackTree(TTree *tree) {
-      tree->Branch("PV_x"     , PV_x     , "PV_x[nPV]/F");
-      tree->Branch("PV_y"     , PV_y     , "PV_y[nPV]/F");
-      tree->Branch("PV_z"     , PV_z     , "PV_z[nPV]/F");
-      tree->Branch("PV_ex"    , PV_ex    , "PV_ex[nPV]/F");
-      tree->Branch("PV_ey"    , PV_ey    , "PV_ey[nPV]/F");
-      tree->Branch("PV_ez"    , PV_ez    , "PV_ez[nPV]/F");
-      tree->Branch("PV_chi2"  , PV_chi2  , "PV_chi2[nPV]/F");
-      tree->Branch("PV_ndf"   , PV_ndf   , "PV_ndf[nPV]/F");
-      tree->Branch("PV_isgood", PV_isgood, "PV_isgood[nPV]/I");
-      tree->Branch("PV_isfake", PV_isfake, "PV_isfake[nPV]/I");
+    BranchRegistry & Registry() { return registry_; }
+    const BranchRegistry & Registry() const { return registry_; }
+
+    // grows the columns to the current counters, to be called before filling the tree;
+    // returns true if a column bound to a branch was reallocated and the branches have to be bound again
+    bool Fit() { return registry_.Fit(); }
+
+    // memory allocated for the columns
+    size_t Capacity() const { return registry_.Capacity(); }
+
+    // counters of the variable-length columns
+    std::vector<std::pair<std::string,const int*> > Counters() const { return registry_.Counters(); }
+
+    // branch selection applied to the following Register* calls, see BranchRegistry::Select
+    template<typename Keep>
+    void Select(const Keep & keep) { registry_.Select(keep, ""); }
+
+    // true if the branch was registered (and not dropped)
+    bool Stored(const std::string & branch) const { return registry_.Stored(branch); }
+
+    // mantissa bits stored for each branch, see BranchRegistry::MantissaBits
+    template<typename Precision>
+    std::vector<int> MantissaBits(const Precision & precision) const { return registry_.MantissaBits(precision, ""); }
+
+    void Truncate(const std::vector<int> & mantissaBits) { registry_.Truncate(mantissaBits); }
+
+    void Register(const BranchTrees & trees, std::string name, Group group) {
+      registry_.Register(trees, name, group);
     }
 
-    void RegisterMuonTree(TTree *tree) {
-      tree->Branch("nMuon"        , &nMuon       , "nMuon/I");
-      tree->Branch("Muon_nMuHit"  , Muon_nMuHit  , "Muon_nMuHit[nMuon]/I");
-      tree->Branch("Muon_nTkHit"  , Muon_nTkHit  , "Muon_nTkHit[nMuon]/I");
-      tree->Branch("Muon_nPixHit" , Muon_nPixHit , "Muon_nPixHit[nMuon]/I");
-      tree->Branch("Muon_nOutHit" , Muon_nOutHit , "Muon_nOutHit[nMuon]/I");
-      tree->Branch("Muon_isGlobal", Muon_isGlobal, "Muon_isGlobal[nMuon]/I");
-      tree->Branch("Muon_isPF"    , Muon_isPF    , "Muon_isPF[nMuon]/I");
-      tree->Branch("Muon_nMatched", Muon_nMatched, "Muon_nMatched[nMuon]/I");
-      tree->Branch("Muon_chi2"    , Muon_chi2    , "Muon_chi2[nMuon]/F");
-      tree->Branch("Muon_chi2Tk"  , Muon_chi2Tk  , "Muon_chi2Tk[nMuon]/F");
-      tree->Branch("Muon_pt"      , Muon_pt      , "Muon_pt[nMuon]/F");
-      tree->Branch("Muon_eta"     , Muon_eta     , "Muon_eta[nMuon]/F");
-      tree->Branch("Muon_phi"     , Muon_phi     , "Muon_phi[nMuon]/F");
-      tree->Branch("Muon_vz"      , Muon_vz      , "Muon_vz[nMuon]/F");
-      tree->Branch("Muon_IP"      , Muon_IP      , "Muon_IP[nMuon]/F");
-      tree->Branch("Muon_IPsig"   , Muon_IPsig   , "Muon_IPsig[nMuon]/F");
-      tree->Branch("Muon_IP2D"    , Muon_IP2D    , "Muon_IP2D[nMuon]/F");
-      tree->Branch("Muon_IP2Dsig" , Muon_IP2Dsig , "Muon_IP2Dsig[nMuon]/F");
+    void Read(const BranchTrees & trees, std::string name, Group group) {
+      registry_.Read(trees, name, group);
     }
 
+    void RegisterTree(const BranchTrees & trees)         { Register(trees, "", Tree); }
+    void RegisterJetTrackTree(const BranchTrees & trees) { Register(trees, "", JetTrackTree); }
+    void RegisterMuonTree(const BranchTrees & trees)     { Register(trees, "", MuonTree); }
+
     //------------------------------------------------------------------------------------------------------------------
 
-    void ReadTree(TTree *tree) {
-      tree->SetBranchAddress("nBitTrigger", &nBitTrigger);
-      tree->SetBranchAddress("BitTrigger" , BitTrigger  );
-      tree->SetBranchAddress("Run"        , &Run        );
-      tree->SetBranchAddress("Evt"        , &Evt        );
-      tree->SetBranchAddress("LumiBlock"  , &LumiBlock  );
-      tree->SetBranchAddress("pthat"      , &pthat      );
-      tree->SetBranchAddress("mcweight"   , &mcweight   );
-      tree->SetBranchAddress("nPV"        , &nPV        );
-      tree->SetBranchAddress("PVz"        , &PVz        );
-      tree->SetBranchAddress("PVez"       , &PVez       );
-      tree->SetBranchAddress("GenPVz"     , &GenPVz     );
-
-      tree->SetBranchAddress("nPUtrue"      , &nPUtrue     );
-      tree->SetBranchAddress("nPU"          , &nPU         );
-      tree->SetBranchAddress("PU_bunch"     , PU_bunch     );
-      tree->SetBranchAddress("PU_z"         , PU_z         );
-      tree->SetBranchAddress("PU_sumpT_low" , PU_sumpT_low );
-      tree->SetBranchAddress("PU_sumpT_high", PU_sumpT_high);
-      tree->SetBranchAddress("PU_ntrks_low" , PU_ntrks_low );
-      tree->SetBranchAddress("PU_ntrks_high", PU_ntrks_high);
-
-      tree->SetBranchAddress("nGenPruned",       &nGenPruned     );
-      tree->SetBranchAddress("GenPruned_pT",     GenPruned_pT    );
-      tree->SetBranchAddress("GenPruned_eta",    GenPruned_eta   );
-      tree->SetBranchAddress("GenPruned_phi",    GenPruned_phi   );
-      tree->SetBranchAddress("GenPruned_mass",    GenPruned_mass   );
-      tree->SetBranchAddress("GenPruned_pdgID",  GenPruned_pdgID );
-      tree->SetBranchAddress("GenPruned_status", GenPruned_status);
-      tree->SetBranchAddress("GenPruned_mother", GenPruned_mother);
-    }
+    void ReadTree(const BranchTrees & trees)             { Read(trees, "", Tree); }
+    void ReadJetTrackTree(const BranchTrees & trees)     { Read(trees, "", JetTrackTree); }
+    void ReadMuonTree(const BranchTrees & trees)         { Read(trees, "", MuonTree); }
 
-    void ReadJetTrackTree(TTree *tree) {
-      tree->SetBranchAddress("PV_x"     , PV_x     );
-      tree->SetBranchAddress("PV_y"     , PV_y     );
-      tree->SetBranchAddress("PV_z"     , PV_z     );
-      tree->SetBranchAddress("PV_ex"    , PV_ex    );
-      tree->SetBranchAddress("PV_ey"    , PV_ey    );
-      tree->SetBranchAddress("PV_ez"    , PV_ez    );
-      tree->SetBranchAddress("PV_chi2"  , PV_chi2  );
-      tree->SetBranchAddress("PV_ndf"   , PV_ndf   );
-      tree->SetBranchAddress("PV_isgood", PV_isgood);
-      tree->SetBranchAddress("PV_isfake", PV_isfake);
-    }
+  private :
 
-    void ReadMuonTree(TTree *tree) {
-      tree->SetBranchAddress("nMuon"        , &nMuon       );
-      tree->SetBranchAddress("Muon_nMuHit"  , Muon_nMuHit  );
-      tree->SetBranchAddress("Muon_nTkHit"  , Muon_nTkHit  );
-      tree->SetBranchAddress("Muon_nPixHit" , Muon_nPixHit );
-      tree->SetBranchAddress("Muon_nOutHit" , Muon_nOutHit );
-      tree->SetBranchAddress("Muon_isGlobal", Muon_isGlobal);
-      tree->SetBranchAddress("Muon_isPF"    , Muon_isPF    );
-      tree->SetBranchAddress("Muon_nMatched", Muon_nMatched);
-      tree->SetBranchAddress("Muon_chi2"    , Muon_chi2    );
-      tree->SetBranchAddress("Muon_chi2Tk"  , Muon_chi2Tk  );
-      tree->SetBranchAddress("Muon_pt"      , Muon_pt      );
-      tree->SetBranchAddress("Muon_eta"     , Muon_eta     );
-      tree->SetBranchAddress("Muon_phi"     , Muon_phi     );
-      tree->SetBranchAddress("Muon_vz"      , Muon_vz      );
-      tree->SetBranchAddress("Muon_IP"      , Muon_IP      );
-      tree->SetBranchAddress("Muon_IPsig"   , Muon_IPsig   );
-      tree->SetBranchAddress("Muon_IP2D"    , Muon_IP2D    );
-      tree->SetBranchAddress("Muon_IP2Dsig" , Muon_IP2Dsig );
-    }
+    EventInfoBranches(const EventInfoBranches&);
+    EventInfoBranches & operator=(const EventInfoBranches&);
+
+    BranchRegistry registry_;
 };
 
 #endif
-
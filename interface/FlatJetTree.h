@@ -0,0 +1,182 @@
+#ifndef FLATJETTREE_H
+#define FLATJETTREE_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <TTree.h>
+
+#include "RecoBTag/BTagAnalyzerLite/interface/BranchRegistry.h"
+
+// Writes one tree entry per jet (e.g. for tagger training): event keys, the jet columns and, for each block of
+// per-jet entries (the CSV tracks or the SVs of the jet, given by the Jet_nFirst*/Jet_nLast* ranges of a counter),
+// the block columns as fixed-length, zero-padded arrays, optionally sorted by one of the block columns (descending).
+// The tree only refers to the registries by entry index, so it can be filled from any set of buffers with the same schema.
+// Jet columns of groups that are not filled are left out, and so are the blocks whose ranges are not filled.
+class FlatJetTree {
+
+  public :
+
+    struct Block {
+      std::string counter;   // counter of the block columns, e.g. nTrkTagVarCSV
+      std::string first;     // per-jet index of the first entry, e.g. Jet_nFirstTrkTagVarCSV
+      std::string last;      // per-jet index past the last entry, e.g. Jet_nLastTrkTagVarCSV
+      std::string sortKey;   // block column to sort the entries by (descending), empty to keep the stored order
+      unsigned int length;   // number of entries stored per jet
+    };
+
+    // keys are event scalars copied to every entry (e.g. Run, Evt), keep(column name) selects the jet and block columns
+    // and filled(group) tells whether the jet columns of a Register*/Read* group are filled
+    template<typename Keep, typename Filled>
+    FlatJetTree(TTree *tree, const BranchRegistry & event, const BranchRegistry & jets,
+                const std::vector<std::string> & keys, const std::vector<Block> & blocks, const Keep & keep, const Filled & filled) :
+      tree_(tree),
+      nJet_(Index(jets, "nJet"))
+    {
+      for( std::vector<std::string>::const_iterator it = keys.begin(); it != keys.end(); ++it ) {
+        const int source = Index(event, *it);
+        if( event.Entries()[source].IsColumn() ) throw std::invalid_argument("FlatJetTree: event key " + *it + " is not a scalar");
+        keys_.push_back( Field(source, 1) );
+      }
+
+      for( size_t i = 0; i < jets.Entries().size(); ++i ) {
+        const BranchEntry & entry = jets.Entries()[i];
+        if( entry.IsColumn() && entry.counter == "nJet" && filled(entry.group) && keep(entry.name) ) jetFields_.push_back( Field(i, 1) );
+      }
+
+      for( std::vector<Block>::const_iterator it = blocks.begin(); it != blocks.end(); ++it ) {
+        BlockFields block;
+        block.first   = Index(jets, it->first);
+        block.last    = Index(jets, it->last);
+        block.sortKey = ( it->sortKey.empty() ? -1 : Index(jets, it->sortKey) );
+        block.length  = it->length;
+        block.count   = 0;
+        if( block.length <= 0 ) throw std::invalid_argument("FlatJetTree: block length of " + it->counter + " has to be positive");
+        if( block.sortKey >= 0 && jets.Entries()[block.sortKey].counter != it->counter )
+          throw std::invalid_argument("FlatJetTree: sort key " + it->sortKey + " is not a column of " + it->counter);
+        if( !filled(jets.Entries()[block.first].group) || !filled(jets.Entries()[block.last].group) ) continue;
+        if( block.sortKey >= 0 && !filled(jets.Entries()[block.sortKey].group) )
+          throw std::invalid_argument("FlatJetTree: sort key " + it->sortKey + " is not filled");
+
+        for( size_t i = 0; i < jets.Entries().size(); ++i ) {
+          const BranchEntry & entry = jets.Entries()[i];
+          if( entry.IsColumn() && entry.counter == it->counter && filled(entry.group) && keep(entry.name) ) block.fields.push_back( Field(i, block.length) );
+        }
+        blocks_.push_back(block);
+        counters_.push_back(it->counter);
+      }
+
+      // the branches are created once all buffers are in place
+      for( std::vector<Field>::iterator it = keys_.begin(); it != keys_.end(); ++it )
+        Branch(event.Entries()[it->source], *it, "");
+      for( std::vector<Field>::iterator it = jetFields_.begin(); it != jetFields_.end(); ++it )
+        Branch(jets.Entries()[it->source], *it, "");
+      for( size_t b = 0; b < blocks_.size(); ++b ) {
+        tree_->Branch(counters_[b].c_str(), &blocks_[b].count, (counters_[b] + "/I").c_str());
+        for( std::vector<Field>::iterator it = blocks_[b].fields.begin(); it != blocks_[b].fields.end(); ++it )
+          Branch(jets.Entries()[it->source], *it, "[" + std::to_string(blocks_[b].length) + "]");
+      }
+    }
+
+    // jet registry entries read by Fill (the jet and block columns and the block ranges and sort keys), in entry order
+    std::vector<size_t> JetEntries() const {
+      std::vector<size_t> entries;
+      entries.push_back(nJet_);
+      for( std::vector<Field>::const_iterator it = jetFields_.begin(); it != jetFields_.end(); ++it ) entries.push_back(it->source);
+      for( std::vector<BlockFields>::const_iterator block = blocks_.begin(); block != blocks_.end(); ++block ) {
+        entries.push_back(block->first);
+        entries.push_back(block->last);
+        if( block->sortKey >= 0 ) entries.push_back(block->sortKey);
+        for( std::vector<Field>::const_iterator it = block->fields.begin(); it != block->fields.end(); ++it ) entries.push_back(it->source);
+      }
+      std::sort(entries.begin(), entries.end());
+      entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+      return entries;
+    }
+
+    // writes one entry for each jet of the current event
+    void Fill(const BranchRegistry & event, const BranchRegistry & jets) {
+      const std::vector<BranchEntry> & eventEntries = event.Entries();
+      const std::vector<BranchEntry> & jetEntries = jets.Entries();
+
+      for( std::vector<Field>::iterator it = keys_.begin(); it != keys_.end(); ++it )
+        it->values[0] = *static_cast<const int32_t*>(eventEntries[it->source].scalar);
+
+      const int nJet = *static_cast<const int*>(jetEntries[nJet_].scalar);
+      for( int iJet = 0; iJet < nJet; ++iJet ) {
+        for( std::vector<Field>::iterator it = jetFields_.begin(); it != jetFields_.end(); ++it )
+          it->values[0] = Words(jetEntries[it->source])[iJet];
+
+        for( std::vector<BlockFields>::iterator block = blocks_.begin(); block != blocks_.end(); ++block ) {
+          const int first = Words(jetEntries[block->first])[iJet];
+          const int last  = Words(jetEntries[block->last])[iJet];
+
+          order_.clear();
+          for( int i = first; i < last; ++i ) order_.push_back(i);
+          if( block->sortKey >= 0 ) {
+            const BranchEntry & key = jetEntries[block->sortKey];
+            std::stable_sort(order_.begin(), order_.end(), [&key](int a, int b) { return Value(key, a) > Value(key, b); });
+          }
+
+          block->count = std::min<int>(order_.size(), block->length);
+          for( std::vector<Field>::iterator it = block->fields.begin(); it != block->fields.end(); ++it ) {
+            const int32_t * source = Words(jetEntries[it->source]);
+            for( int i = 0; i < block->count; ++i ) it->values[i] = source[order_[i]];
+            std::fill(it->values.begin() + block->count, it->values.end(), 0);
+          }
+        }
+
+        tree_->Fill();
+      }
+    }
+
+  private :
+
+    static_assert(sizeof(float) == sizeof(int32_t) && sizeof(int) == sizeof(int32_t), "int and float branches are copied as 32-bit words");
+
+    // output buffer of one branch, int and float values are both kept as 32-bit words
+    struct Field {
+      Field(size_t source, size_t length) : source(source), values(length, 0) {}
+
+      size_t source;                 // index of the source entry in its registry
+      std::vector<int32_t> values;
+    };
+
+    struct BlockFields {
+      int first, last, sortKey;
+      int length;
+      int count;                     // number of entries stored for the current jet
+      std::vector<Field> fields;
+    };
+
+    static int Index(const BranchRegistry & registry, const std::string & name) {
+      const std::vector<BranchEntry> & entries = registry.Entries();
+      for( size_t i = 0; i < entries.size(); ++i )
+        if( entries[i].name == name ) return i;
+      throw std::invalid_argument("FlatJetTree: unknown branch " + name);
+    }
+
+    static const int32_t * Words(const BranchEntry & entry) { return static_cast<const int32_t*>(entry.column->Address()); }
+
+    static double Value(const BranchEntry & entry, int i) {
+      if( entry.type == BranchLeafType<float>::code() ) return static_cast<const float*>(entry.column->Address())[i];
+      return static_cast<const int*>(entry.column->Address())[i];
+    }
+
+    void Branch(const BranchEntry & entry, Field & field, const std::string & dimension) {
+      tree_->Branch(entry.name.c_str(), &field.values[0], (entry.name + dimension + "/" + entry.type).c_str());
+    }
+
+    TTree * tree_;
+    const int nJet_;
+    std::vector<Field> keys_;
+    std::vector<Field> jetFields_;
+    std::vector<BlockFields> blocks_;
+    std::vector<std::string> counters_;  // counter name of each block
+    std::vector<int> order_;
+};
+
+#endif
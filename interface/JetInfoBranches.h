@@ -1,845 +1,365 @@
 #ifndef JETINFOBRANCHES_H
 #define JETINFOBRANCHES_H
 
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <TTree.h>
 
-const UInt_t nMaxJets_ = 10000;
-const UInt_t nMaxTrk_  = 100000;
-const UInt_t nMaxMuons_= 10000;
-const UInt_t nMaxElectrons_= 10000;
-const UInt_t nMaxSVs_= 10000;
+#include "RecoBTag/BTagAnalyzerLite/interface/BranchRegistry.h"
+
+// Branch schema: every branch appears once, in the order the branches are created, as
+//   SCALAR(type, name, group)           a single value
+//   COLUMN(type, name, counter, group)  one value per entry, the number of entries is given by the counter
+// The members, the Register*/Read* functions and the BranchRegistry used at run time are generated from it.
+#define JETINFO_BRANCHES(SCALAR, COLUMN) \
+  SCALAR(int,   nJet,                                                     Tree              )                                                                                             \
+  COLUMN(float, Jet_pt,                             nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_genpt,                          nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_residual,                       nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_jes,                            nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_eta,                            nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_phi,                            nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_mass,                           nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_ntracks,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_nseltracks,                     nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_flavour,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_nbHadrons,                      nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_ncHadrons,                      nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_ProbaN,                         nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_ProbaP,                         nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_Proba,                          nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_BprobN,                         nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_BprobP,                         nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_Bprob,                          nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_SvxN,                           nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_Svx,                            nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_SvxNHP,                         nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_SvxHP,                          nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_CombSvxN,                       nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_CombSvxP,                       nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_CombSvx,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_CombIVF,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_CombIVF_P,                      nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_CombIVF_N,                      nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_SoftMuN,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_SoftMuP,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_SoftMu,                         nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_SoftElN,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_SoftElP,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(float, Jet_SoftEl,                         nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_nFirstTrack,                    nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_nLastTrack,                     nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_nFirstSV,                       nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_nLastSV,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_SV_multi,                       nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_looseID,                        nJet,                 Tree              )                                                                                             \
+  COLUMN(int,   Jet_tightID,                        nJet,                 Tree              )                                                                                             \
+  /* secondary vertex information */                                                                                                                                                      \
+  SCALAR(int,   nSV,                                                      Tree              )                                                                                             \
+  COLUMN(float, SV_x,                               nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_y,                               nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_z,                               nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_ex,                              nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_ey,                              nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_ez,                              nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_chi2,                            nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_ndf,                             nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_flight,                          nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_flightErr,                       nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_deltaR_jet,                      nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_deltaR_sum_jet,                  nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_deltaR_sum_dir,                  nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_vtx_pt,                          nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_flight2D,                        nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_flight2DErr,                     nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_totCharge,                       nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_vtxDistJetAxis,                  nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_EnergyRatio,                     nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_dir_x,                           nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_dir_y,                           nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_dir_z,                           nSV,                  Tree              )                                                                                             \
+  COLUMN(int,   SV_nTrk,                            nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_mass,                            nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_vtx_eta,                         nSV,                  Tree              )                                                                                             \
+  COLUMN(float, SV_vtx_phi,                         nSV,                  Tree              )                                                                                             \
+  /* pf electron information */                                                                                                                                                           \
+  SCALAR(int,   nPFElectron,                                              JetPFLeptonTree   )                                                                                             \
+  COLUMN(int,   PFElectron_IdxJet,                  nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFElectron_pt,                      nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFElectron_eta,                     nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFElectron_phi,                     nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFElectron_ptrel,                   nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFElectron_deltaR,                  nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFElectron_ratio,                   nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFElectron_ratioRel,                nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFElectron_IP,                      nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFElectron_IP2D,                    nPFElectron,          JetPFLeptonTree   )                                                                                             \
+  /* pf muon information */                                                                                                                                                               \
+  SCALAR(int,   nPFMuon,                                                  JetPFLeptonTree   )                                                                                             \
+  COLUMN(int,   PFMuon_IdxJet,                      nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFMuon_pt,                          nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFMuon_eta,                         nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFMuon_phi,                         nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFMuon_ptrel,                       nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFMuon_deltaR,                      nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFMuon_ratio,                       nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFMuon_ratioRel,                    nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFMuon_IP,                          nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  COLUMN(float, PFMuon_IP2D,                        nPFMuon,              JetPFLeptonTree   )                                                                                             \
+  /* track information */                                                                                                                                                                 \
+  SCALAR(int,   nTrack,                                                   JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_dxy,                          nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_dz,                           nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_zIP,                          nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_length,                       nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_dist,                         nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_IP2D,                         nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_IP2Dsig,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_IP2Derr,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_IP,                           nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_IPsig,                        nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_IPerr,                        nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_Proba,                        nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_p,                            nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_pt,                           nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_eta,                          nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_phi,                          nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_chi2,                         nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_charge,                       nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_nHitStrip,                    nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_nHitPixel,                    nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_nHitAll,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_nHitTIB,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_nHitTID,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_nHitTOB,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_nHitTEC,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_nHitPXB,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_nHitPXF,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_isHitL1,                      nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_PV,                           nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_SV,                           nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_PVweight,                     nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(float, Track_SVweight,                     nTrack,               JetTrackTree      )                                                                                             \
+  COLUMN(int,   Track_isfromSV,                     nTrack,               JetTrackTree      )                                                                                             \
+  /* TagInfo TaggingVariables */                                                                                                                                                          \
+  COLUMN(int,   Jet_nFirstTrkTagVar,                nJet,                 TagVarTree        )                                                                                             \
+  COLUMN(int,   Jet_nLastTrkTagVar,                 nJet,                 TagVarTree        )                                                                                             \
+  COLUMN(int,   Jet_nFirstSVTagVar,                 nJet,                 TagVarTree        )                                                                                             \
+  COLUMN(int,   Jet_nLastSVTagVar,                  nJet,                 TagVarTree        )                                                                                             \
+  COLUMN(float, TagVar_jetNTracks,                  nJet,                 TagVarTree        ) /* tracks associated to jet */                                                              \
+  COLUMN(float, TagVar_jetNSecondaryVertices,       nJet,                 TagVarTree        ) /* number of reconstructed possible secondary vertices in jet */                            \
+  COLUMN(float, TagVar_chargedHadronEnergyFraction, nJet,                 TagVarTree        ) /* fraction of the jet energy coming from charged hadrons */                                \
+  COLUMN(float, TagVar_neutralHadronEnergyFraction, nJet,                 TagVarTree        ) /* fraction of the jet energy coming from neutral hadrons */                                \
+  COLUMN(float, TagVar_photonEnergyFraction,        nJet,                 TagVarTree        ) /* fraction of the jet energy coming from photons */                                        \
+  COLUMN(float, TagVar_electronEnergyFraction,      nJet,                 TagVarTree        ) /* fraction of the jet energy coming from electrons */                                      \
+  COLUMN(float, TagVar_muonEnergyFraction,          nJet,                 TagVarTree        ) /* fraction of the jet energy coming from muons */                                          \
+  COLUMN(float, TagVar_chargedHadronMultiplicity,   nJet,                 TagVarTree        ) /* number of charged hadrons in the jet */                                                  \
+  COLUMN(float, TagVar_neutralHadronMultiplicity,   nJet,                 TagVarTree        ) /* number of neutral hadrons in the jet */                                                  \
+  COLUMN(float, TagVar_photonMultiplicity,          nJet,                 TagVarTree        ) /* number of photons in the jet */                                                          \
+  COLUMN(float, TagVar_electronMultiplicity,        nJet,                 TagVarTree        ) /* number of electrons in the jet */                                                        \
+  COLUMN(float, TagVar_muonMultiplicity,            nJet,                 TagVarTree        ) /* number of muons in the jet */                                                            \
+  SCALAR(int,   nTrkTagVar,                                               TagVarTree        )                                                                                             \
+  COLUMN(float, TagVar_trackMomentum,               nTrkTagVar,           TagVarTree        ) /* track momentum */                                                                        \
+  COLUMN(float, TagVar_trackEta,                    nTrkTagVar,           TagVarTree        ) /* track pseudorapidity */                                                                  \
+  COLUMN(float, TagVar_trackPhi,                    nTrkTagVar,           TagVarTree        ) /* track polar angle */                                                                     \
+  COLUMN(float, TagVar_trackPtRel,                  nTrkTagVar,           TagVarTree        ) /* track transverse momentum, relative to the jet axis */                                   \
+  COLUMN(float, TagVar_trackPPar,                   nTrkTagVar,           TagVarTree        ) /* track parallel momentum, along the jet axis */                                           \
+  COLUMN(float, TagVar_trackEtaRel,                 nTrkTagVar,           TagVarTree        ) /* track pseudorapidity, relative to the jet axis */                                        \
+  COLUMN(float, TagVar_trackDeltaR,                 nTrkTagVar,           TagVarTree        ) /* track pseudoangular distance from the jet axis */                                        \
+  COLUMN(float, TagVar_trackPtRatio,                nTrkTagVar,           TagVarTree        ) /* track transverse momentum, relative to the jet axis, normalized to its energy */         \
+  COLUMN(float, TagVar_trackPParRatio,              nTrkTagVar,           TagVarTree        ) /* track parallel momentum, along the jet axis, normalized to its energy */                 \
+  COLUMN(float, TagVar_trackSip2dVal,               nTrkTagVar,           TagVarTree        ) /* track 2D signed impact parameter */                                                      \
+  COLUMN(float, TagVar_trackSip2dSig,               nTrkTagVar,           TagVarTree        ) /* track 2D signed impact parameter significance */                                         \
+  COLUMN(float, TagVar_trackSip3dVal,               nTrkTagVar,           TagVarTree        ) /* track 3D signed impact parameter */                                                      \
+  COLUMN(float, TagVar_trackSip3dSig,               nTrkTagVar,           TagVarTree        ) /* track 3D signed impact parameter significance */                                         \
+  COLUMN(float, TagVar_trackDecayLenVal,            nTrkTagVar,           TagVarTree        ) /* track decay length */                                                                    \
+  COLUMN(float, TagVar_trackDecayLenSig,            nTrkTagVar,           TagVarTree        ) /* track decay length significance */                                                       \
+  COLUMN(float, TagVar_trackJetDistVal,             nTrkTagVar,           TagVarTree        ) /* minimum track approach distance to jet axis */                                           \
+  COLUMN(float, TagVar_trackJetDistSig,             nTrkTagVar,           TagVarTree        ) /* minimum track approach distance to jet axis significance */                              \
+  COLUMN(float, TagVar_trackChi2,                   nTrkTagVar,           TagVarTree        ) /* track fit chi2 */                                                                        \
+  COLUMN(float, TagVar_trackNTotalHits,             nTrkTagVar,           TagVarTree        ) /* number of valid total hits */                                                            \
+  COLUMN(float, TagVar_trackNPixelHits,             nTrkTagVar,           TagVarTree        ) /* number of valid pixel hits */                                                            \
+  SCALAR(int,   nSVTagVar,                                                TagVarTree        )                                                                                             \
+  COLUMN(float, TagVar_vertexMass,                  nSVTagVar,            TagVarTree        ) /* mass of track sum at secondary vertex */                                                 \
+  COLUMN(float, TagVar_vertexNTracks,               nSVTagVar,            TagVarTree        ) /* number of tracks at secondary vertex */                                                  \
+  COLUMN(float, TagVar_vertexJetDeltaR,             nSVTagVar,            TagVarTree        ) /* pseudoangular distance between jet axis and secondary vertex direction */                \
+  COLUMN(float, TagVar_flightDistance2dVal,         nSVTagVar,            TagVarTree        ) /* transverse distance between primary and secondary vertex */                              \
+  COLUMN(float, TagVar_flightDistance2dSig,         nSVTagVar,            TagVarTree        ) /* transverse distance significance between primary and secondary vertex */                 \
+  COLUMN(float, TagVar_flightDistance3dVal,         nSVTagVar,            TagVarTree        ) /* distance between primary and secondary vertex */                                         \
+  COLUMN(float, TagVar_flightDistance3dSig,         nSVTagVar,            TagVarTree        ) /* distance significance between primary and secondary vertex */                            \
+  /* CSV TaggingVariables */                                                                                                                                                              \
+  COLUMN(int,   Jet_nFirstTrkTagVarCSV,             nJet,                 CSVTagVarTree     )                                                                                             \
+  COLUMN(int,   Jet_nLastTrkTagVarCSV,              nJet,                 CSVTagVarTree     )                                                                                             \
+  COLUMN(int,   Jet_nFirstTrkEtaRelTagVarCSV,       nJet,                 CSVTagVarTree     )                                                                                             \
+  COLUMN(int,   Jet_nLastTrkEtaRelTagVarCSV,        nJet,                 CSVTagVarTree     )                                                                                             \
+  COLUMN(float, TagVarCSV_trackJetPt,               nJet,                 CSVTagVarTree     ) /* track-based jet transverse momentum */                                                   \
+  COLUMN(float, TagVarCSV_jetNTracks,               nJet,                 CSVTagVarTree     ) /* tracks associated to jet */                                                              \
+  COLUMN(float, TagVarCSV_jetNTracksEtaRel,         nJet,                 CSVTagVarTree     ) /* tracks associated to jet for which trackEtaRel is calculated */                          \
+  COLUMN(float, TagVarCSV_trackSumJetEtRatio,       nJet,                 CSVTagVarTree     ) /* ratio of track sum transverse energy over jet energy */                                  \
+  COLUMN(float, TagVarCSV_trackSumJetDeltaR,        nJet,                 CSVTagVarTree     ) /* pseudoangular distance between jet axis and track fourvector sum */                      \
+  COLUMN(float, TagVarCSV_trackSip2dValAboveCharm,  nJet,                 CSVTagVarTree     ) /* track 2D signed impact parameter of first track lifting mass above charm */              \
+  COLUMN(float, TagVarCSV_trackSip2dSigAboveCharm,  nJet,                 CSVTagVarTree     ) /* track 2D signed impact parameter significance of first track lifting mass above charm */ \
+  COLUMN(float, TagVarCSV_trackSip3dValAboveCharm,  nJet,                 CSVTagVarTree     ) /* track 3D signed impact parameter of first track lifting mass above charm */              \
+  COLUMN(float, TagVarCSV_trackSip3dSigAboveCharm,  nJet,                 CSVTagVarTree     ) /* track 3D signed impact parameter significance of first track lifting mass above charm */ \
+  COLUMN(float, TagVarCSV_vertexCategory,           nJet,                 CSVTagVarTree     ) /* category of secondary vertex (Reco, Pseudo, No) */                                       \
+  COLUMN(float, TagVarCSV_jetNSecondaryVertices,    nJet,                 CSVTagVarTree     ) /* number of reconstructed possible secondary vertices in jet */                            \
+  COLUMN(float, TagVarCSV_vertexMass,               nJet,                 CSVTagVarTree     ) /* mass of track sum at secondary vertex */                                                 \
+  COLUMN(float, TagVarCSV_vertexNTracks,            nJet,                 CSVTagVarTree     ) /* number of tracks at secondary vertex */                                                  \
+  COLUMN(float, TagVarCSV_vertexEnergyRatio,        nJet,                 CSVTagVarTree     ) /* ratio of energy at secondary vertex over total energy */                                 \
+  COLUMN(float, TagVarCSV_vertexJetDeltaR,          nJet,                 CSVTagVarTree     ) /* pseudoangular distance between jet axis and secondary vertex direction */                \
+  COLUMN(float, TagVarCSV_flightDistance2dVal,      nJet,                 CSVTagVarTree     ) /* transverse distance between primary and secondary vertex */                              \
+  COLUMN(float, TagVarCSV_flightDistance2dSig,      nJet,                 CSVTagVarTree     ) /* transverse distance significance between primary and secondary vertex */                 \
+  COLUMN(float, TagVarCSV_flightDistance3dVal,      nJet,                 CSVTagVarTree     ) /* distance between primary and secondary vertex */                                         \
+  COLUMN(float, TagVarCSV_flightDistance3dSig,      nJet,                 CSVTagVarTree     ) /* distance significance between primary and secondary vertex */                            \
+  SCALAR(int,   nTrkTagVarCSV,                                            CSVTagVarTree     )                                                                                             \
+  SCALAR(int,   nTrkEtaRelTagVarCSV,                                      CSVTagVarTree     )                                                                                             \
+  COLUMN(float, TagVarCSV_trackMomentum,            nTrkTagVarCSV,        CSVTagVarTree     ) /* track momentum */                                                                        \
+  COLUMN(float, TagVarCSV_trackEta,                 nTrkTagVarCSV,        CSVTagVarTree     ) /* track pseudorapidity */                                                                  \
+  COLUMN(float, TagVarCSV_trackPhi,                 nTrkTagVarCSV,        CSVTagVarTree     ) /* track polar angle */                                                                     \
+  COLUMN(float, TagVarCSV_trackPtRel,               nTrkTagVarCSV,        CSVTagVarTree     ) /* track transverse momentum, relative to the jet axis */                                   \
+  COLUMN(float, TagVarCSV_trackPPar,                nTrkTagVarCSV,        CSVTagVarTree     ) /* track parallel momentum, along the jet axis */                                           \
+  COLUMN(float, TagVarCSV_trackDeltaR,              nTrkTagVarCSV,        CSVTagVarTree     ) /* track pseudoangular distance from the jet axis */                                        \
+  COLUMN(float, TagVarCSV_trackPtRatio,             nTrkTagVarCSV,        CSVTagVarTree     ) /* track transverse momentum, relative to the jet axis, normalized to its energy */         \
+  COLUMN(float, TagVarCSV_trackPParRatio,           nTrkTagVarCSV,        CSVTagVarTree     ) /* track parallel momentum, along the jet axis, normalized to its energy */                 \
+  COLUMN(float, TagVarCSV_trackSip2dVal,            nTrkTagVarCSV,        CSVTagVarTree     ) /* track 2D signed impact parameter */                                                      \
+  COLUMN(float, TagVarCSV_trackSip2dSig,            nTrkTagVarCSV,        CSVTagVarTree     ) /* track 2D signed impact parameter significance */                                         \
+  COLUMN(float, TagVarCSV_trackSip3dVal,            nTrkTagVarCSV,        CSVTagVarTree     ) /* track 3D signed impact parameter */                                                      \
+  COLUMN(float, TagVarCSV_trackSip3dSig,            nTrkTagVarCSV,        CSVTagVarTree     ) /* track 3D signed impact parameter significance */                                         \
+  COLUMN(float, TagVarCSV_trackDecayLenVal,         nTrkTagVarCSV,        CSVTagVarTree     ) /* track decay length */                                                                    \
+  COLUMN(float, TagVarCSV_trackDecayLenSig,         nTrkTagVarCSV,        CSVTagVarTree     ) /* track decay length significance */                                                       \
+  COLUMN(float, TagVarCSV_trackJetDistVal,          nTrkTagVarCSV,        CSVTagVarTree     ) /* minimum track approach distance to jet axis */                                           \
+  COLUMN(float, TagVarCSV_trackJetDistSig,          nTrkTagVarCSV,        CSVTagVarTree     ) /* minimum track approach distance to jet axis significance */                              \
+  COLUMN(float, TagVarCSV_trackEtaRel,              nTrkEtaRelTagVarCSV,  CSVTagVarTree     ) /* track pseudorapidity, relative to the jet axis */                                        \
+  COLUMN(int,   Jet_FatJetIdx,                      nJet,                 SubJetSpecificTree)                                                                                             \
+  COLUMN(float, Jet_ptGroomed,                      nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(float, Jet_jesGroomed,                     nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(float, Jet_etaGroomed,                     nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(float, Jet_phiGroomed,                     nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(float, Jet_massGroomed,                    nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(float, Jet_tau1,                           nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(float, Jet_tau2,                           nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(float, Jet_tau1IVF,                        nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(float, Jet_tau2IVF,                        nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(int,   Jet_nSubJets,                       nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(int,   Jet_nFirstSJ,                       nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(int,   Jet_nLastSJ,                        nJet,                 FatJetSpecificTree)                                                                                             \
+  SCALAR(int,   nSubJet,                                                  FatJetSpecificTree)                                                                                             \
+  COLUMN(int,   SubJetIdx,                          nSubJet,              FatJetSpecificTree)                                                                                             \
+  COLUMN(int,   Jet_nsharedtracks,                  nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(int,   Jet_nsubjettracks,                  nJet,                 FatJetSpecificTree)                                                                                             \
+  COLUMN(int,   Jet_nsharedsubjettracks,            nJet,                 FatJetSpecificTree)
 
 class JetInfoBranches {
 
   public :
 
-    int   nJet;
-    float Jet_pt[nMaxJets_];
-    float Jet_genpt[nMaxJets_];
-    float Jet_residual[nMaxJets_];
-    float Jet_jes[nMaxJets_];
-    float Jet_eta[nMaxJets_];
-    float Jet_phi[nMaxJets_];
-    float Jet_mass[nMaxJets_];
-    float Jet_ProbaN[nMaxJets_];
-    float Jet_ProbaP[nMaxJets_];
-    float Jet_Proba[nMaxJets_];
-    float Jet_BprobN[nMaxJets_];
-    float Jet_BprobP[nMaxJets_];
-    float Jet_Bprob[nMaxJets_];
-    float Jet_SvxN[nMaxJets_];
-    float Jet_Svx[nMaxJets_];
-    float Jet_SvxNHP[nMaxJets_];
-    float Jet_SvxHP[nMaxJets_];
-    float Jet_CombSvxN[nMaxJets_];
-    float Jet_CombSvxP[nMaxJets_];
-    float Jet_CombSvx[nMaxJets_];
-    float Jet_CombIVF[nMaxJets_];
-    float Jet_CombIVF_P[nMaxJets_];
-    float Jet_CombIVF_N[nMaxJets_];
-    float Jet_SoftMuN[nMaxJets_];
-    float Jet_SoftMuP[nMaxJets_];
-    float Jet_SoftMu[nMaxJets_];
-    float Jet_SoftElN[nMaxJets_];
-    float Jet_SoftElP[nMaxJets_];
-    float Jet_SoftEl[nMaxJets_];
-    int   Jet_ntracks[nMaxJets_];
-    int   Jet_nseltracks[nMaxJets_];
-    int   Jet_nsharedtracks[nMaxJets_];
-    int   Jet_nsubjettracks[nMaxJets_];
-    int   Jet_nsharedsubjettracks[nMaxJets_];
-    int   Jet_flavour[nMaxJets_];
-    int   Jet_nbHadrons[nMaxJets_];
-    int   Jet_ncHadrons[nMaxJets_];
-    int   Jet_nFirstTrack[nMaxJets_];
-    int   Jet_nLastTrack[nMaxJets_];
-    int   Jet_nFirstSV[nMaxJets_];
-    int   Jet_nLastSV[nMaxJets_];
-    int   Jet_SV_multi[nMaxJets_];
-    int   Jet_looseID[nMaxJets_];
-    int   Jet_tightID[nMaxJets_];
-    int   Jet_FatJetIdx[nMaxJets_];
-    float Jet_ptGroomed[nMaxJets_];
-    float Jet_jesGroomed[nMaxJets_];
-    float Jet_etaGroomed[nMaxJets_];
-    float Jet_phiGroomed[nMaxJets_];
-    float Jet_massGroomed[nMaxJets_];
-    float Jet_tau1[nMaxJets_];
-    float Jet_tau2[nMaxJets_];
-    float Jet_tau1IVF[nMaxJets_];
-    float Jet_tau2IVF[nMaxJets_];
-    int   Jet_nSubJets[nMaxJets_];
-    int   Jet_nFirstSJ[nMaxJets_];
-    int   Jet_nLastSJ[nMaxJets_];
-    int   Jet_nFirstTrkTagVar[nMaxJets_];
-    int   Jet_nLastTrkTagVar[nMaxJets_];
-    int   Jet_nFirstSVTagVar[nMaxJets_];
-    int   Jet_nLastSVTagVar[nMaxJets_];
-    int   Jet_nFirstTrkTagVarCSV[nMaxJets_];
-    int   Jet_nLastTrkTagVarCSV[nMaxJets_];
-    int   Jet_nFirstTrkEtaRelTagVarCSV[nMaxJets_];
-    int   Jet_nLastTrkEtaRelTagVarCSV[nMaxJets_];
+    // groups of branches registered together
+    enum Group { Tree, JetPFLeptonTree, JetTrackTree, TagVarTree, CSVTagVarTree, SubJetSpecificTree, FatJetSpecificTree };
+
+#define JETINFO_DECLARE_SCALAR(type, name, group)          type name;
+#define JETINFO_DECLARE_COLUMN(type, name, counter, group) BranchColumn<type> name;
+    JETINFO_BRANCHES(JETINFO_DECLARE_SCALAR, JETINFO_DECLARE_COLUMN)
+#undef JETINFO_DECLARE_SCALAR
+#undef JETINFO_DECLARE_COLUMN
+
+    JetInfoBranches() {
+#define JETINFO_ADD_SCALAR(type, name, group)          name = type(); registry_.AddScalar(#name, &name, group);
+#define JETINFO_ADD_COLUMN(type, name, counter, group) registry_.AddColumn(#name, &name, #counter, &counter, group);
+      JETINFO_BRANCHES(JETINFO_ADD_SCALAR, JETINFO_ADD_COLUMN)
+#undef JETINFO_ADD_SCALAR
+#undef JETINFO_ADD_COLUMN
+    }
 
-    int   nSubJet;
-    int   SubJetIdx[nMaxJets_];
+    // adds a float nJet column outside of the schema (e.g. a configured discriminator), to be called before Register/Read
+    BranchColumn<float> & AddJetColumn(const std::string & name) {
+      if( registry_.Find(name) ) throw std::invalid_argument("JetInfoBranches: branch " + name + " already exists");
 
-    int   nTrack;
-    float Track_dxy[nMaxTrk_];
-    float Track_dz[nMaxTrk_];
-    float Track_zIP[nMaxTrk_];
-    float Track_LongIP[nMaxTrk_];
-    float Track_length[nMaxTrk_];
-    float Track_dist[nMaxTrk_];
-    float Track_IP2D[nMaxTrk_];
-    float Track_IP2Dsig[nMaxTrk_];
-    float Track_IP2Derr[nMaxTrk_];
-    float Track_IP[nMaxTrk_];
-    float Track_IPsig[nMaxTrk_];
-    float Track_IPerr[nMaxTrk_];
-    float Track_Proba[nMaxTrk_];
-    float Track_p[nMaxTrk_];
-    float Track_pt[nMaxTrk_];
-    float Track_eta[nMaxTrk_];
-    float Track_phi[nMaxTrk_];
-    float Track_chi2[nMaxTrk_];
-    int   Track_charge[nMaxTrk_];
-    int   Track_nHitStrip[nMaxTrk_];
-    int   Track_nHitPixel[nMaxTrk_];
-    int   Track_nHitAll[nMaxTrk_];
-    int   Track_nHitTIB[nMaxTrk_];
-    int   Track_nHitTID[nMaxTrk_];
-    int   Track_nHitTOB[nMaxTrk_];
-    int   Track_nHitTEC[nMaxTrk_];
-    int   Track_nHitPXB[nMaxTrk_];
-    int   Track_nHitPXF[nMaxTrk_];
-    int   Track_isHitL1[nMaxTrk_];
-    int   Track_PV[nMaxTrk_];
-    int   Track_SV[nMaxTrk_];
-    int   Track_isfromSV[nMaxTrk_];
-    float Track_PVweight[nMaxTrk_];
-    float Track_SVweight[nMaxTrk_];
+      jetColumns_.push_back( std::unique_ptr<BranchColumn<float> >(new BranchColumn<float>()) );
+      registry_.AddColumn(name, jetColumns_.back().get(), "nJet", &nJet, Tree);
+      return *jetColumns_.back();
+    }
 
-    int   nPFElectron;
-    int   PFElectron_IdxJet[nMaxElectrons_];
-    float PFElectron_pt[nMaxElectrons_];
-    float PFElectron_eta[nMaxElectrons_];
-    float PFElectron_phi[nMaxElectrons_];
-    float PFElectron_ptrel[nMaxElectrons_];
-    float PFElectron_ratio[nMaxElectrons_];
-    float PFElectron_ratioRel[nMaxElectrons_];
-    float PFElectron_deltaR[nMaxElectrons_];
-    float PFElectron_IP[nMaxElectrons_];
-    float PFElectron_IP2D[nMaxElectrons_];
+    // float nJet column of a branch: the schema column if there is one (e.g. Jet_CombIVF), otherwise a column added with AddJetColumn
+    BranchColumn<float> & JetColumn(const std::string & name) {
+      const BranchEntry * entry = registry_.Find(name);
+      if( !entry ) return AddJetColumn(name);
 
-    int   nPFMuon;
-    int   PFMuon_IdxJet[nMaxElectrons_];
-    float PFMuon_pt[nMaxElectrons_];
-    float PFMuon_eta[nMaxElectrons_];
-    float PFMuon_phi[nMaxElectrons_];
-    float PFMuon_ptrel[nMaxElectrons_];
-    float PFMuon_ratio[nMaxElectrons_];
-    float PFMuon_ratioRel[nMaxElectrons_];
-    float PFMuon_deltaR[nMaxElectrons_];
-    float PFMuon_IP[nMaxElectrons_];
-    float PFMuon_IP2D[nMaxElectrons_];
+      if( !entry->IsColumn() || entry->counter != "nJet" || entry->type != BranchLeafType<float>::code() )
+        throw std::invalid_argument("JetInfoBranches: branch " + name + " is not a float nJet column");
+      return *static_cast<BranchColumn<float>*>(entry->column);
+    }
 
-    int   nSV;
-    float SV_x[nMaxSVs_];
-    float SV_y[nMaxSVs_];
-    float SV_z[nMaxSVs_];
-    float SV_ex[nMaxSVs_];
-    float SV_ey[nMaxSVs_];
-    float SV_ez[nMaxSVs_];
-    float SV_chi2[nMaxSVs_];
-    float SV_ndf[nMaxSVs_];
-    float SV_flight[nMaxSVs_];
-    float SV_flightErr[nMaxSVs_];
-    float SV_deltaR_jet[nMaxSVs_];
-    float SV_deltaR_sum_jet[nMaxSVs_];
-    float SV_deltaR_sum_dir[nMaxSVs_];
-    float SV_vtx_pt[nMaxSVs_];
-    float SV_flight2D[nMaxSVs_];
-    float SV_flight2DErr[nMaxSVs_];
-    float SV_totCharge[nMaxSVs_];
-    float SV_vtxDistJetAxis[nMaxSVs_];
-    int   SV_nTrk[nMaxSVs_];
-    float SV_mass[nMaxSVs_];
-    float SV_vtx_eta[nMaxSVs_];
-    float SV_vtx_phi[nMaxSVs_];
-    float SV_EnergyRatio[nMaxSVs_];
-    float SV_dir_x[nMaxSVs_];
-    float SV_dir_y[nMaxSVs_];
-    float SV_dir_z[nMaxSVs_]; 	  
+    BranchRegistry & Registry() { return registry_; }
+    const BranchRegistry & Registry() const { return registry_; }
 
-    // TagInfo TaggingVariables
-    // per jet
-    float TagVar_jetNTracks[nMaxJets_];                              // tracks associated to jet
-    float TagVar_jetNSecondaryVertices[nMaxJets_];                   // number of reconstructed possible secondary vertices in jet
-    float TagVar_chargedHadronEnergyFraction[nMaxJets_];             // fraction of the jet energy coming from charged hadrons
-    float TagVar_neutralHadronEnergyFraction[nMaxJets_];             // fraction of the jet energy coming from neutral hadrons
-    float TagVar_photonEnergyFraction[nMaxJets_];                    // fraction of the jet energy coming from photons
-    float TagVar_electronEnergyFraction[nMaxJets_];                  // fraction of the jet energy coming from electrons
-    float TagVar_muonEnergyFraction[nMaxJets_];                      // fraction of the jet energy coming from muons
-    float TagVar_chargedHadronMultiplicity[nMaxJets_];               // number of charged hadrons in the jet
-    float TagVar_neutralHadronMultiplicity[nMaxJets_];               // number of neutral hadrons in the jet
-    float TagVar_photonMultiplicity[nMaxJets_];                      // number of photons in the jet
-    float TagVar_electronMultiplicity[nMaxJets_];                    // number of electrons in the jet
-    float TagVar_muonMultiplicity[nMaxJets_];                        // number of muons in the jet
-    // per jet per track
-    int   nTrkTagVar;
-    float TagVar_trackMomentum[nMaxTrk_];                            // track momentum
-    float TagVar_trackEta[nMaxTrk_];                                 // track pseudorapidity
-    float TagVar_trackPhi[nMaxTrk_];                                 // track polar angle
-    float TagVar_trackPtRel[nMaxTrk_];                               // track transverse momentum, relative to the jet axis
-    float TagVar_trackPPar[nMaxTrk_];                                // track parallel momentum, along the jet axis
-    float TagVar_trackEtaRel[nMaxTrk_];                              // track pseudorapidity, relative to the jet axis
-    float TagVar_trackDeltaR[nMaxTrk_];                              // track pseudoangular distance from the jet axis
-    float TagVar_trackPtRatio[nMaxTrk_];                             // track transverse momentum, relative to the jet axis, normalized to its energy
-    float TagVar_trackPParRatio[nMaxTrk_];                           // track parallel momentum, along the jet axis, normalized to its energy
-    float TagVar_trackSip2dVal[nMaxTrk_];                            // track 2D signed impact parameter
-    float TagVar_trackSip2dSig[nMaxTrk_];                            // track 2D signed impact parameter significance
-    float TagVar_trackSip3dVal[nMaxTrk_];                            // track 3D signed impact parameter
-    float TagVar_trackSip3dSig[nMaxTrk_];                            // track 3D signed impact parameter significance
-    float TagVar_trackDecayLenVal[nMaxTrk_];                         // track decay length
-    float TagVar_trackDecayLenSig[nMaxTrk_];                         // track decay length significance
-    float TagVar_trackJetDistVal[nMaxTrk_];                          // minimum track approach distance to jet axis
-    float TagVar_trackJetDistSig[nMaxTrk_];                          // minimum track approach distance to jet axis significance
-    float TagVar_trackChi2[nMaxTrk_];                                // track fit chi2
-    float TagVar_trackNTotalHits[nMaxTrk_];                          // number of valid total hits
-    float TagVar_trackNPixelHits[nMaxTrk_];                          // number of valid pixel hits
-    // per jet per secondary vertex
-    int   nSVTagVar;
-    float TagVar_vertexMass[nMaxSVs_];                               // mass of track sum at secondary vertex
-    float TagVar_vertexNTracks[nMaxSVs_];                            // number of tracks at secondary vertex
-    float TagVar_vertexJetDeltaR[nMaxSVs_];                          // pseudoangular distance between jet axis and secondary vertex direction
-    float TagVar_flightDistance2dVal[nMaxSVs_];                      // transverse distance between primary and secondary vertex
-    float TagVar_flightDistance2dSig[nMaxSVs_];                      // transverse distance significance between primary and secondary vertex
-    float TagVar_flightDistance3dVal[nMaxSVs_];                      // distance between primary and secondary vertex
-    float TagVar_flightDistance3dSig[nMaxSVs_];                      // distance significance between primary and secondary vertex
+    // grows the columns to the current counters, to be called before filling the tree;
+    // returns true if a column bound to a branch was reallocated and the branches have to be bound again
+    bool Fit() { return registry_.Fit(); }
 
-    // CSV TaggingVariables
-    // per jet
-    float TagVarCSV_trackJetPt[nMaxJets_];                           // track-based jet transverse momentum
-    float TagVarCSV_jetNTracks[nMaxJets_];                           // tracks associated to jet
-    float TagVarCSV_jetNTracksEtaRel[nMaxJets_];                     // tracks associated to jet for which trackEtaRel is calculated
-    float TagVarCSV_trackSumJetEtRatio[nMaxJets_];                   // ratio of track sum transverse energy over jet energy
-    float TagVarCSV_trackSumJetDeltaR[nMaxJets_];                    // pseudoangular distance between jet axis and track fourvector sum
-    float TagVarCSV_trackSip2dValAboveCharm[nMaxJets_];              // track 2D signed impact parameter of first track lifting mass above charm
-    float TagVarCSV_trackSip2dSigAboveCharm[nMaxJets_];              // track 2D signed impact parameter significance of first track lifting mass above charm
-    float TagVarCSV_trackSip3dValAboveCharm[nMaxJets_];              // track 3D signed impact parameter of first track lifting mass above charm
-    float TagVarCSV_trackSip3dSigAboveCharm[nMaxJets_];              // track 3D signed impact parameter significance of first track lifting mass above charm
-    float TagVarCSV_vertexCategory[nMaxJets_];                       // category of secondary vertex (Reco, Pseudo, No)
-    float TagVarCSV_jetNSecondaryVertices[nMaxJets_];                // number of reconstructed possible secondary vertices in jet
-    float TagVarCSV_vertexMass[nMaxJets_];                           // mass of track sum at secondary vertex
-    float TagVarCSV_vertexNTracks[nMaxJets_];                        // number of tracks at secondary vertex
-    float TagVarCSV_vertexEnergyRatio[nMaxJets_];                    // ratio of energy at secondary vertex over total energy
-    float TagVarCSV_vertexJetDeltaR[nMaxJets_];                      // pseudoangular distance between jet axis and secondary vertex direction
-    float TagVarCSV_flightDistance2dVal[nMaxJets_];                  // transverse distance between primary and secondary vertex
-    float TagVarCSV_flightDistance2dSig[nMaxJets_];                  // transverse distance significance between primary and secondary vertex
-    float TagVarCSV_flightDistance3dVal[nMaxJets_];                  // distance between primary and secondary vertex
-    float TagVarCSV_flightDistance3dSig[nMaxJets_];                  // distance significance between primary and secondary vertex
-    // per jet per track
-    int   nTrkTagVarCSV;
-    int   nTrkEtaRelTagVarCSV;
-    float TagVarCSV_trackMomentum[nMaxTrk_];                         // track momentum
-    float TagVarCSV_trackEta[nMaxTrk_];                              // track pseudorapidity
-    float TagVarCSV_trackPhi[nMaxTrk_];                              // track polar angle
-    float TagVarCSV_trackPtRel[nMaxTrk_];                            // track transverse momentum, relative to the jet axis
-    float TagVarCSV_trackPPar[nMaxTrk_];                             // track parallel momentum, along the jet axis
-    float TagVarCSV_trackDeltaR[nMaxTrk_];                           // track pseudoangular distance from the jet axis
-    float TagVarCSV_trackPtRatio[nMaxTrk_];                          // track transverse momentum, relative to the jet axis, normalized to its energy
-    float TagVarCSV_trackPParRatio[nMaxTrk_];                        // track parallel momentum, along the jet axis, normalized to its energy
-    float TagVarCSV_trackSip2dVal[nMaxTrk_];                         // track 2D signed impact parameter
-    float TagVarCSV_trackSip2dSig[nMaxTrk_];                         // track 2D signed impact parameter significance
-    float TagVarCSV_trackSip3dVal[nMaxTrk_];                         // track 3D signed impact parameter
-    float TagVarCSV_trackSip3dSig[nMaxTrk_];                         // track 3D signed impact parameter significance
-    float TagVarCSV_trackDecayLenVal[nMaxTrk_];                      // track decay length
-    float TagVarCSV_trackDecayLenSig[nMaxTrk_];                      // track decay length significance
-    float TagVarCSV_trackJetDistVal[nMaxTrk_];                       // minimum track approach distance to jet axis
-    float TagVarCSV_trackJetDistSig[nMaxTrk_];                       // minimum track approach distance to jet axis significance
-    float TagVarCSV_trackEtaRel[nMaxTrk_];                           // track pseudorapidity, relative to the jet axis
+    // memory allocated for the columns
+    size_t Capacity() const { return registry_.Capacity(); }
 
+    // counters of the variable-length columns
+    std::vector<std::pair<std::string,const int*> > Counters() const { return registry_.Counters(); }
 
-    void RegisterTree(TTree *tree, std::string name="") {
+    // branch selection applied to the following Register* calls, see BranchRegistry::Select
+    template<typename Keep>
+    void Select(const Keep & keep, std::string name="") {
       if(name!="") name += ".";
-      tree->Branch((name+"nJet").c_str(),            &nJet           ,(name+"nJet/I").c_str());
-      tree->Branch((name+"Jet_pt").c_str(),          Jet_pt        ,(name+"Jet_pt["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_genpt").c_str(),       Jet_genpt       ,(name+"Jet_genpt["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_residual").c_str(),    Jet_residual    ,(name+"Jet_residual["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_jes").c_str(),         Jet_jes         ,(name+"Jet_jes["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_eta").c_str(),         Jet_eta         ,(name+"Jet_eta["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_phi").c_str(),         Jet_phi         ,(name+"Jet_phi["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_mass").c_str(),        Jet_mass        ,(name+"Jet_mass["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_ntracks").c_str(),     Jet_ntracks     ,(name+"Jet_ntracks["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_nseltracks").c_str(),  Jet_nseltracks  ,(name+"Jet_nseltracks["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_flavour").c_str(),     Jet_flavour     ,(name+"Jet_flavour["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_nbHadrons").c_str(),   Jet_nbHadrons   ,(name+"Jet_nbHadrons["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_ncHadrons").c_str(),   Jet_ncHadrons   ,(name+"Jet_ncHadrons["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_ProbaN").c_str(),      Jet_ProbaN     ,(name+"Jet_ProbaN["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_ProbaP").c_str(),      Jet_ProbaP     ,(name+"Jet_ProbaP["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_Proba").c_str(),       Jet_Proba      ,(name+"Jet_Proba["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_BprobN").c_str(),      Jet_BprobN     ,(name+"Jet_BprobN["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_BprobP").c_str(),      Jet_BprobP     ,(name+"Jet_BprobP["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_Bprob").c_str(),       Jet_Bprob      ,(name+"Jet_Bprob["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_SvxN").c_str(),        Jet_SvxN       ,(name+"Jet_SvxN["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_Svx").c_str(),         Jet_Svx        ,(name+"Jet_Svx["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_SvxNHP").c_str(),      Jet_SvxNHP     ,(name+"Jet_SvxNHP["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_SvxHP").c_str(),       Jet_SvxHP      ,(name+"Jet_SvxHP["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_CombSvxN").c_str(),    Jet_CombSvxN   ,(name+"Jet_CombSvxN["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_CombSvxP").c_str(),    Jet_CombSvxP   ,(name+"Jet_CombSvxP["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_CombSvx").c_str(),     Jet_CombSvx    ,(name+"Jet_CombSvx["+name+"nJet]/F").c_str());
-
-      tree->Branch((name+"Jet_CombIVF").c_str(),     Jet_CombIVF     ,(name+"Jet_CombIVF["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_CombIVF_P").c_str(),   Jet_CombIVF_P   ,(name+"Jet_CombIVF_P["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_CombIVF_N").c_str(),   Jet_CombIVF_N   ,(name+"Jet_CombIVF_N["+name+"nJet]/F").c_str());
-
-      tree->Branch((name+"Jet_SoftMuN").c_str(),     Jet_SoftMuN     ,(name+"Jet_SoftMuN["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_SoftMuP").c_str(),     Jet_SoftMuP     ,(name+"Jet_SoftMuP["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_SoftMu").c_str(),      Jet_SoftMu      ,(name+"Jet_SoftMu["+name+"nJet]/F").c_str());
-
-      tree->Branch((name+"Jet_SoftElN").c_str(),     Jet_SoftElN     ,(name+"Jet_SoftElN["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_SoftElP").c_str(),     Jet_SoftElP     ,(name+"Jet_SoftElP["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_SoftEl").c_str(),      Jet_SoftEl      ,(name+"Jet_SoftEl["+name+"nJet]/F").c_str());
-
-      tree->Branch((name+"Jet_nFirstTrack").c_str(), Jet_nFirstTrack ,(name+"Jet_nFirstTrack["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_nLastTrack").c_str(),  Jet_nLastTrack  ,(name+"Jet_nLastTrack["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_nFirstSV").c_str(),    Jet_nFirstSV    ,(name+"Jet_nFirstSV["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_nLastSV").c_str(),     Jet_nLastSV     ,(name+"Jet_nLastSV["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_SV_multi").c_str(),    Jet_SV_multi      ,(name+"Jet_SV_multi["+name+"nJet]/I").c_str());
-
-      tree->Branch((name+"Jet_looseID").c_str(),      Jet_looseID  ,(name+"Jet_looseID["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_tightID").c_str(),      Jet_tightID  ,(name+"Jet_tightID["+name+"nJet]/I").c_str());
-
-      //--------------------------------------
-      // secondary vertex information
-      //--------------------------------------
-      tree->Branch((name+"nSV").c_str()                ,&nSV               ,(name+"nSV/I").c_str());
-      tree->Branch((name+"SV_x").c_str()               ,SV_x                 ,(name+"SV_x["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_y").c_str()               ,SV_y                 ,(name+"SV_y["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_z").c_str()               ,SV_z                 ,(name+"SV_z["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_ex").c_str()              ,SV_ex              ,(name+"SV_ex["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_ey").c_str()              ,SV_ey              ,(name+"SV_ey["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_ez").c_str()              ,SV_ez              ,(name+"SV_ez["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_chi2").c_str()            ,SV_chi2            ,(name+"SV_chi2["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_ndf").c_str()             ,SV_ndf             ,(name+"SV_ndf["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_flight").c_str()          ,SV_flight          ,(name+"SV_flight["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_flightErr").c_str()       ,SV_flightErr       ,(name+"SV_flightErr["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_deltaR_jet").c_str()      ,SV_deltaR_jet      ,(name+"SV_deltaR_jet["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_deltaR_sum_jet").c_str()  ,SV_deltaR_sum_jet  ,(name+"SV_deltaR_sum_jet["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_deltaR_sum_dir").c_str()  ,SV_deltaR_sum_dir  ,(name+"SV_deltaR_sum_dir["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_vtx_pt").c_str()          ,SV_vtx_pt             ,(name+"SV_vtx_pt["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_flight2D").c_str()        ,SV_flight2D        ,(name+"SV_flight2D["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_flight2DErr").c_str()     ,SV_flight2DErr     ,(name+"SV_flight2DErr["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_totCharge").c_str()       ,SV_totCharge       ,(name+"SV_totCharge ["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_vtxDistJetAxis").c_str()  ,SV_vtxDistJetAxis  ,(name+"SV_vtxDistJetAxis ["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_EnergyRatio").c_str()  ,SV_EnergyRatio  ,(name+"SV_EnergyRatio ["+name+"nSV]/F").c_str());	
-      tree->Branch((name+"SV_dir_x").c_str()  ,SV_dir_x  ,(name+"SV_dir_x ["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_dir_y").c_str()  ,SV_dir_y  ,(name+"SV_dir_y ["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_dir_z").c_str()  ,SV_dir_z  ,(name+"SV_dir_z ["+name+"nSV]/F").c_str());	
-      tree->Branch((name+"SV_nTrk").c_str()            ,SV_nTrk            ,(name+"SV_nTrk["+name+"nSV]/I").c_str());
-      tree->Branch((name+"SV_mass").c_str()            ,SV_mass            ,(name+"SV_mass["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_vtx_eta").c_str()         ,SV_vtx_eta         ,(name+"SV_vtx_eta["+name+"nSV]/F").c_str());
-      tree->Branch((name+"SV_vtx_phi").c_str()         ,SV_vtx_phi         ,(name+"SV_vtx_phi["+name+"nSV]/F").c_str());
+      registry_.Select(keep, name);
     }
 
-    void RegisterJetPFLeptonTree(TTree *tree, std::string name="") {
-      if(name!="") name += ".";
-      //--------------------------------------
-      // pf electron information
-      //--------------------------------------
-      tree->Branch((name+"nPFElectron").c_str()         ,&nPFElectron   ,(name+"nPFElectron/I").c_str());
-      tree->Branch((name+"PFElectron_IdxJet").c_str()   ,PFElectron_IdxJet   ,(name+"PFElectron_IdxJet["+name+"nPFElectron]/I").c_str());
-      tree->Branch((name+"PFElectron_pt").c_str()       ,PFElectron_pt       ,(name+"PFElectron_pt["+name+"nPFElectron]/F").c_str());
-      tree->Branch((name+"PFElectron_eta").c_str()      ,PFElectron_eta      ,(name+"PFElectron_eta["+name+"nPFElectron]/F").c_str());
-      tree->Branch((name+"PFElectron_phi").c_str()      ,PFElectron_phi      ,(name+"PFElectron_phi["+name+"nPFElectron]/F").c_str());
-      tree->Branch((name+"PFElectron_ptrel").c_str()    ,PFElectron_ptrel    ,(name+"PFElectron_ptrel["+name+"nPFElectron]/F").c_str());
-      tree->Branch((name+"PFElectron_deltaR").c_str()   ,PFElectron_deltaR   ,(name+"PFElectron_deltaR["+name+"nPFElectron]/F").c_str());
-      tree->Branch((name+"PFElectron_ratio").c_str()    ,PFElectron_ratio    ,(name+"PFElectron_ratio["+name+"nPFElectron]/F").c_str());
-      tree->Branch((name+"PFElectron_ratioRel").c_str() ,PFElectron_ratioRel ,(name+"PFElectron_ratioRel["+name+"nPFElectron]/F").c_str());
-      tree->Branch((name+"PFElectron_IP").c_str()       ,PFElectron_IP       ,(name+"PFElectron_IP["+name+"nPFElectron]/F").c_str());
-      tree->Branch((name+"PFElectron_IP2D").c_str()     ,PFElectron_IP2D     ,(name+"PFElectron_IP2D["+name+"nPFElectron]/F").c_str());
-
-      //--------------------------------------
-      // pf muon information
-      //--------------------------------------
-      tree->Branch((name+"nPFMuon").c_str()            ,&nPFMuon            ,(name+"nPFMuon/I").c_str());
-      tree->Branch((name+"PFMuon_IdxJet").c_str()      ,PFMuon_IdxJet       ,(name+"PFMuon_IdxJet["+name+"nPFMuon]/I").c_str());
-      tree->Branch((name+"PFMuon_pt").c_str()          ,PFMuon_pt           ,(name+"PFMuon_pt["+name+"nPFMuon]/F").c_str());
-      tree->Branch((name+"PFMuon_eta").c_str()         ,PFMuon_eta          ,(name+"PFMuon_eta["+name+"nPFMuon]/F").c_str());
-      tree->Branch((name+"PFMuon_phi").c_str()         ,PFMuon_phi          ,(name+"PFMuon_phi["+name+"nPFMuon]/F").c_str());
-      tree->Branch((name+"PFMuon_ptrel").c_str()       ,PFMuon_ptrel        ,(name+"PFMuon_ptrel["+name+"nPFMuon]/F").c_str());
-      tree->Branch((name+"PFMuon_deltaR").c_str()      ,PFMuon_deltaR       ,(name+"PFMuon_deltaR["+name+"nPFMuon]/F").c_str());
-      tree->Branch((name+"PFMuon_ratio").c_str()       ,PFMuon_ratio        ,(name+"PFMuon_ratio["+name+"nPFMuon]/F").c_str());
-      tree->Branch((name+"PFMuon_ratioRel").c_str()    ,PFMuon_ratioRel     ,(name+"PFMuon_ratioRel["+name+"nPFMuon]/F").c_str());
-      tree->Branch((name+"PFMuon_IP").c_str()          ,PFMuon_IP           ,(name+"PFMuon_IP["+name+"nPFMuon]/F").c_str());
-      tree->Branch((name+"PFMuon_IP2D").c_str()        ,PFMuon_IP2D         ,(name+"PFMuon_IP2D["+name+"nPFMuon]/F").c_str());
-    }
+    // true if the branch was registered (and not dropped)
+    bool Stored(const std::string & branch) const { return registry_.Stored(branch); }
 
-    void RegisterJetTrackTree(TTree *tree, std::string name="") {
+    // mantissa bits stored for each branch, see BranchRegistry::MantissaBits
+    template<typename Precision>
+    std::vector<int> MantissaBits(const Precision & precision, std::string name="") const {
       if(name!="") name += ".";
-      //--------------------------------------
-      // track information
-      //--------------------------------------
-      tree->Branch((name+"nTrack").c_str()           ,&nTrack          ,(name+"nTrack/I").c_str());
-      tree->Branch((name+"Track_dxy").c_str()        ,Track_dxy             ,(name+"Track_dxy["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_dz").c_str()         ,Track_dz         ,(name+"Track_dz["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_zIP").c_str()        ,Track_zIP             ,(name+"Track_zIP["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_length").c_str()     ,Track_length     ,(name+"Track_length["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_dist").c_str()       ,Track_dist            ,(name+"Track_dist["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_IP2D").c_str()       ,Track_IP2D            ,(name+"Track_IP2D["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_IP2Dsig").c_str()    ,Track_IP2Dsig    ,(name+"Track_IP2Dsig["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_IP2Derr").c_str()    ,Track_IP2Derr    ,(name+"Track_IP2Derr["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_IP").c_str()         ,Track_IP         ,(name+"Track_IP["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_IPsig").c_str()      ,Track_IPsig      ,(name+"Track_IPsig["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_IPerr").c_str()      ,Track_IPerr      ,(name+"Track_IPerr["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_Proba").c_str()      ,Track_Proba      ,(name+"Track_Proba["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_p").c_str()          ,Track_p          ,(name+"Track_p["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_pt").c_str()         ,Track_pt         ,(name+"Track_pt["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_eta").c_str()        ,Track_eta             ,(name+"Track_eta["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_phi").c_str()        ,Track_phi             ,(name+"Track_phi["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_chi2").c_str()       ,Track_chi2            ,(name+"Track_chi2["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_charge").c_str()     ,Track_charge     ,(name+"Track_charge["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_nHitStrip").c_str()  ,Track_nHitStrip  ,(name+"Track_nHitStrip["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_nHitPixel").c_str()  ,Track_nHitPixel  ,(name+"Track_nHitPixel["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_nHitAll").c_str()    ,Track_nHitAll    ,(name+"Track_nHitAll["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_nHitTIB").c_str()    ,Track_nHitTIB    ,(name+"Track_nHitTIB["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_nHitTID").c_str()    ,Track_nHitTID    ,(name+"Track_nHitTID["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_nHitTOB").c_str()    ,Track_nHitTOB    ,(name+"Track_nHitTOB["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_nHitTEC").c_str()    ,Track_nHitTEC    ,(name+"Track_nHitTEC["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_nHitPXB").c_str()    ,Track_nHitPXB    ,(name+"Track_nHitPXB["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_nHitPXF").c_str()    ,Track_nHitPXF    ,(name+"Track_nHitPXF["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_isHitL1").c_str()    ,Track_isHitL1    ,(name+"Track_isHitL1["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_PV").c_str()         ,Track_PV         ,(name+"Track_PV["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_SV").c_str()         ,Track_SV         ,(name+"Track_SV["+name+"nTrack]/I").c_str());
-      tree->Branch((name+"Track_PVweight").c_str()   ,Track_PVweight   ,(name+"Track_PVweight["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_SVweight").c_str()   ,Track_SVweight   ,(name+"Track_SVweight["+name+"nTrack]/F").c_str());
-      tree->Branch((name+"Track_isfromSV").c_str()   ,Track_isfromSV   ,(name+"Track_isfromSV["+name+"nTrack]/I").c_str());
+      return registry_.MantissaBits(precision, name);
     }
 
-    void RegisterTagVarTree(TTree *tree, std::string name=""){
-      if(name!="") name += ".";
-      //--------------------------------------
-      // TagInfo TaggingVariables
-      //--------------------------------------
-      tree->Branch((name+"Jet_nFirstTrkTagVar").c_str()  ,Jet_nFirstTrkTagVar  ,(name+"Jet_nFirstTrkTagVar["+name+"nJet]/I").c_str() );
-      tree->Branch((name+"Jet_nLastTrkTagVar").c_str()   ,Jet_nLastTrkTagVar   ,(name+"Jet_nLastTrack["+name+"nJet]/I").c_str()      );
-      tree->Branch((name+"Jet_nFirstSVTagVar").c_str()   ,Jet_nFirstSVTagVar   ,(name+"Jet_nFirstSVTagVar["+name+"nJet]/I").c_str()  );
-      tree->Branch((name+"Jet_nLastSVTagVar").c_str()    ,Jet_nLastSVTagVar    ,(name+"Jet_nLastSVTagVar["+name+"nJet]/I").c_str()   );
-
-      tree->Branch((name+"TagVar_jetNTracks").c_str()                   ,TagVar_jetNTracks                   ,(name+"TagVar_jetNTracks["+name+"nJet]/F").c_str()                   );
-      tree->Branch((name+"TagVar_jetNSecondaryVertices").c_str()        ,TagVar_jetNSecondaryVertices        ,(name+"TagVar_jetNSecondaryVertices["+name+"nJet]/F").c_str()        );
-      tree->Branch((name+"TagVar_chargedHadronEnergyFraction").c_str()  ,TagVar_chargedHadronEnergyFraction  ,(name+"TagVar_chargedHadronEnergyFraction["+name+"nJet]/F").c_str()  );
-      tree->Branch((name+"TagVar_neutralHadronEnergyFraction").c_str()  ,TagVar_neutralHadronEnergyFraction  ,(name+"TagVar_neutralHadronEnergyFraction["+name+"nJet]/F").c_str()  );
-      tree->Branch((name+"TagVar_photonEnergyFraction").c_str()         ,TagVar_photonEnergyFraction         ,(name+"TagVar_photonEnergyFraction["+name+"nJet]/F").c_str()         );
-      tree->Branch((name+"TagVar_electronEnergyFraction").c_str()       ,TagVar_electronEnergyFraction       ,(name+"TagVar_electronEnergyFraction["+name+"nJet]/F").c_str()       );
-      tree->Branch((name+"TagVar_muonEnergyFraction").c_str()           ,TagVar_muonEnergyFraction           ,(name+"TagVar_muonEnergyFraction["+name+"nJet]/F").c_str()           );
-      tree->Branch((name+"TagVar_chargedHadronMultiplicity").c_str()    ,TagVar_chargedHadronMultiplicity    ,(name+"TagVar_chargedHadronMultiplicity["+name+"nJet]/F").c_str()    );
-      tree->Branch((name+"TagVar_neutralHadronMultiplicity").c_str()    ,TagVar_neutralHadronMultiplicity    ,(name+"TagVar_neutralHadronMultiplicity["+name+"nJet]/F").c_str()    );
-      tree->Branch((name+"TagVar_photonMultiplicity").c_str()           ,TagVar_photonMultiplicity           ,(name+"TagVar_photonMultiplicity["+name+"nJet]/F").c_str()           );
-      tree->Branch((name+"TagVar_electronMultiplicity").c_str()         ,TagVar_electronMultiplicity         ,(name+"TagVar_electronMultiplicity["+name+"nJet]/F").c_str()         );
-      tree->Branch((name+"TagVar_muonMultiplicity").c_str()             ,TagVar_muonMultiplicity             ,(name+"TagVar_muonMultiplicity["+name+"nJet]/F").c_str()             );
-
-      tree->Branch((name+"nTrkTagVar").c_str()               ,&nTrkTagVar              ,(name+"nTrkTagVar/I").c_str()                                  );
-      tree->Branch((name+"TagVar_trackMomentum").c_str()     ,TagVar_trackMomentum     ,(name+"TagVar_trackMomentum["+name+"nTrkTagVar]/F").c_str()    );
-      tree->Branch((name+"TagVar_trackEta").c_str()          ,TagVar_trackEta          ,(name+"TagVar_trackEta["+name+"nTrkTagVar]/F").c_str()         );
-      tree->Branch((name+"TagVar_trackPhi").c_str()          ,TagVar_trackPhi          ,(name+"TagVar_trackPhi["+name+"nTrkTagVar]/F").c_str()         );
-      tree->Branch((name+"TagVar_trackPtRel").c_str()        ,TagVar_trackPtRel        ,(name+"TagVar_trackPtRel["+name+"nTrkTagVar]/F").c_str()       );
-      tree->Branch((name+"TagVar_trackPPar").c_str()         ,TagVar_trackPPar         ,(name+"TagVar_trackPPar["+name+"nTrkTagVar]/F").c_str()        );
-      tree->Branch((name+"TagVar_trackEtaRel").c_str()       ,TagVar_trackEtaRel       ,(name+"TagVar_trackEtaRel["+name+"nTrkTagVar]/F").c_str()      );
-      tree->Branch((name+"TagVar_trackDeltaR").c_str()       ,TagVar_trackDeltaR       ,(name+"TagVar_trackDeltaR["+name+"nTrkTagVar]/F").c_str()      );
-      tree->Branch((name+"TagVar_trackPtRatio").c_str()      ,TagVar_trackPtRatio      ,(name+"TagVar_trackPtRatio["+name+"nTrkTagVar]/F").c_str()     );
-      tree->Branch((name+"TagVar_trackPParRatio").c_str()    ,TagVar_trackPParRatio    ,(name+"TagVar_trackPParRatio["+name+"nTrkTagVar]/F").c_str()   );
-      tree->Branch((name+"TagVar_trackSip2dVal").c_str()     ,TagVar_trackSip2dVal     ,(name+"TagVar_trackSip2dVal["+name+"nTrkTagVar]/F").c_str()    );
-      tree->Branch((name+"TagVar_trackSip2dSig").c_str()     ,TagVar_trackSip2dSig     ,(name+"TagVar_trackSip2dSig["+name+"nTrkTagVar]/F").c_str()    );
-      tree->Branch((name+"TagVar_trackSip3dVal").c_str()     ,TagVar_trackSip3dVal     ,(name+"TagVar_trackSip3dVal["+name+"nTrkTagVar]/F").c_str()    );
-      tree->Branch((name+"TagVar_trackSip3dSig").c_str()     ,TagVar_trackSip3dSig     ,(name+"TagVar_trackSip3dSig["+name+"nTrkTagVar]/F").c_str()    );
-      tree->Branch((name+"TagVar_trackDecayLenVal").c_str()  ,TagVar_trackDecayLenVal  ,(name+"TagVar_trackDecayLenVal["+name+"nTrkTagVar]/F").c_str() );
-      tree->Branch((name+"TagVar_trackDecayLenSig").c_str()  ,TagVar_trackDecayLenSig  ,(name+"TagVar_trackDecayLenSig["+name+"nTrkTagVar]/F").c_str() );
-      tree->Branch((name+"TagVar_trackJetDistVal").c_str()   ,TagVar_trackJetDistVal   ,(name+"TagVar_trackJetDistVal["+name+"nTrkTagVar]/F").c_str()  );
-      tree->Branch((name+"TagVar_trackJetDistSig").c_str()   ,TagVar_trackJetDistSig   ,(name+"TagVar_trackJetDistSig["+name+"nTrkTagVar]/F").c_str()  );
-      tree->Branch((name+"TagVar_trackChi2").c_str()         ,TagVar_trackChi2         ,(name+"TagVar_trackChi2["+name+"nTrkTagVar]/F").c_str()        );
-      tree->Branch((name+"TagVar_trackNTotalHits").c_str()   ,TagVar_trackNTotalHits   ,(name+"TagVar_trackNTotalHits["+name+"nTrkTagVar]/F").c_str()  );
-      tree->Branch((name+"TagVar_trackNPixelHits").c_str()   ,TagVar_trackNPixelHits   ,(name+"TagVar_trackNPixelHits["+name+"nTrkTagVar]/F").c_str()  );
-
-      tree->Branch((name+"nSVTagVar").c_str()                       ,&nSVTagVar                      ,(name+"nSVTagVar/I").c_str()                                     );
-      tree->Branch((name+"TagVar_vertexMass").c_str()               ,TagVar_vertexMass               ,(name+"TagVar_vertexMass["+name+"nSVTagVar]/F").c_str()          );
-      tree->Branch((name+"TagVar_vertexNTracks").c_str()            ,TagVar_vertexNTracks            ,(name+"TagVar_vertexNTracks["+name+"nSVTagVar]/F").c_str()       );
-      tree->Branch((name+"TagVar_vertexJetDeltaR").c_str()          ,TagVar_vertexJetDeltaR          ,(name+"TagVar_vertexJetDeltaR["+name+"nSVTagVar]/F").c_str()     );
-      tree->Branch((name+"TagVar_flightDistance2dVal").c_str()      ,TagVar_flightDistance2dVal      ,(name+"TagVar_flightDistance2dVal["+name+"nSVTagVar]/F").c_str() );
-      tree->Branch((name+"TagVar_flightDistance2dSig").c_str()      ,TagVar_flightDistance2dSig      ,(name+"TagVar_flightDistance2dSig["+name+"nSVTagVar]/F").c_str() );
-      tree->Branch((name+"TagVar_flightDistance3dVal").c_str()      ,TagVar_flightDistance3dVal      ,(name+"TagVar_flightDistance3dVal["+name+"nSVTagVar]/F").c_str() );
-      tree->Branch((name+"TagVar_flightDistance3dSig").c_str()      ,TagVar_flightDistance3dSig      ,(name+"TagVar_flightDistance3dSig["+name+"nSVTagVar]/F").c_str() );
-
-    }
+    void Truncate(const std::vector<int> & mantissaBits) { registry_.Truncate(mantissaBits); }
 
-    void RegisterCSVTagVarTree(TTree *tree, std::string name=""){
+    void Register(const BranchTrees & trees, std::string name, Group group) {
       if(name!="") name += ".";
-      //--------------------------------------
-      // CSV TaggingVariables
-      //--------------------------------------
-      tree->Branch((name+"Jet_nFirstTrkTagVarCSV").c_str()        ,Jet_nFirstTrkTagVarCSV        ,(name+"Jet_nFirstTrkTagVarCSV["+name+"nJet]/I").c_str()       );
-      tree->Branch((name+"Jet_nLastTrkTagVarCSV").c_str()         ,Jet_nLastTrkTagVarCSV         ,(name+"Jet_nLastTrackCSV["+name+"nJet]/I").c_str()            );
-      tree->Branch((name+"Jet_nFirstTrkEtaRelTagVarCSV").c_str()  ,Jet_nFirstTrkEtaRelTagVarCSV  ,(name+"Jet_nFirstTrkEtaRelTagVarCSV["+name+"nJet]/I").c_str() );
-      tree->Branch((name+"Jet_nLastTrkEtaRelTagVarCSV").c_str()   ,Jet_nLastTrkEtaRelTagVarCSV   ,(name+"Jet_nLastEtaRelTrackCSV["+name+"nJet]/I").c_str()      );
-
-      tree->Branch((name+"TagVarCSV_trackJetPt").c_str()               ,TagVarCSV_trackJetPt               ,(name+"TagVarCSV_trackJetPt["+name+"nJet]/F").c_str()              );
-      tree->Branch((name+"TagVarCSV_jetNTracks").c_str()               ,TagVarCSV_jetNTracks               ,(name+"TagVarCSV_jetNTracks["+name+"nJet]/F").c_str()              );
-      tree->Branch((name+"TagVarCSV_jetNTracksEtaRel").c_str()         ,TagVarCSV_jetNTracksEtaRel         ,(name+"TagVarCSV_jetNTracksEtaRel["+name+"nJet]/F").c_str()        );
-      tree->Branch((name+"TagVarCSV_trackSumJetEtRatio").c_str()       ,TagVarCSV_trackSumJetEtRatio       ,(name+"TagVarCSV_trackSumJetEtRatio["+name+"nJet]/F").c_str()      );
-      tree->Branch((name+"TagVarCSV_trackSumJetDeltaR").c_str()        ,TagVarCSV_trackSumJetDeltaR        ,(name+"TagVarCSV_trackSumJetDeltaR["+name+"nJet]/F").c_str()       );
-      tree->Branch((name+"TagVarCSV_trackSip2dValAboveCharm").c_str()  ,TagVarCSV_trackSip2dValAboveCharm  ,(name+"TagVarCSV_trackSip2dValAboveCharm["+name+"nJet]/F").c_str() );
-      tree->Branch((name+"TagVarCSV_trackSip2dSigAboveCharm").c_str()  ,TagVarCSV_trackSip2dSigAboveCharm  ,(name+"TagVarCSV_trackSip2dSigAboveCharm["+name+"nJet]/F").c_str() );
-      tree->Branch((name+"TagVarCSV_trackSip3dValAboveCharm").c_str()  ,TagVarCSV_trackSip3dValAboveCharm  ,(name+"TagVarCSV_trackSip3dValAboveCharm["+name+"nJet]/F").c_str() );
-      tree->Branch((name+"TagVarCSV_trackSip3dSigAboveCharm").c_str()  ,TagVarCSV_trackSip3dSigAboveCharm  ,(name+"TagVarCSV_trackSip3dSigAboveCharm["+name+"nJet]/F").c_str() );
-      tree->Branch((name+"TagVarCSV_vertexCategory").c_str()           ,TagVarCSV_vertexCategory           ,(name+"TagVarCSV_vertexCategory["+name+"nJet]/F").c_str()          );
-      tree->Branch((name+"TagVarCSV_jetNSecondaryVertices").c_str()    ,TagVarCSV_jetNSecondaryVertices    ,(name+"TagVarCSV_jetNSecondaryVertices["+name+"nJet]/F").c_str()   );
-      tree->Branch((name+"TagVarCSV_vertexMass").c_str()               ,TagVarCSV_vertexMass               ,(name+"TagVarCSV_vertexMass["+name+"nJet]/F").c_str()              );
-      tree->Branch((name+"TagVarCSV_vertexNTracks").c_str()            ,TagVarCSV_vertexNTracks            ,(name+"TagVarCSV_vertexNTracks["+name+"nJet]/F").c_str()           );
-      tree->Branch((name+"TagVarCSV_vertexEnergyRatio").c_str()        ,TagVarCSV_vertexEnergyRatio        ,(name+"TagVarCSV_vertexEnergyRatio["+name+"nJet]/F").c_str()       );
-      tree->Branch((name+"TagVarCSV_vertexJetDeltaR").c_str()          ,TagVarCSV_vertexJetDeltaR          ,(name+"TagVarCSV_vertexJetDeltaR["+name+"nJet]/F").c_str()         );
-      tree->Branch((name+"TagVarCSV_flightDistance2dVal").c_str()      ,TagVarCSV_flightDistance2dVal      ,(name+"TagVarCSV_flightDistance2dVal["+name+"nJet]/F").c_str()     );
-      tree->Branch((name+"TagVarCSV_flightDistance2dSig").c_str()      ,TagVarCSV_flightDistance2dSig      ,(name+"TagVarCSV_flightDistance2dSig["+name+"nJet]/F").c_str()     );
-      tree->Branch((name+"TagVarCSV_flightDistance3dVal").c_str()      ,TagVarCSV_flightDistance3dVal      ,(name+"TagVarCSV_flightDistance3dVal["+name+"nJet]/F").c_str()     );
-      tree->Branch((name+"TagVarCSV_flightDistance3dSig").c_str()      ,TagVarCSV_flightDistance3dSig      ,(name+"TagVarCSV_flightDistance3dSig["+name+"nJet]/F").c_str()     );
-
-      tree->Branch((name+"nTrkTagVarCSV").c_str()               ,&nTrkTagVarCSV              ,(name+"nTrkTagVarCSV/I").c_str()                                      );
-      tree->Branch((name+"nTrkEtaRelTagVarCSV").c_str()         ,&nTrkEtaRelTagVarCSV        ,(name+"nTrkEtaRelTagVarCSV/I").c_str()                                );
-      tree->Branch((name+"TagVarCSV_trackMomentum").c_str()     ,TagVarCSV_trackMomentum     ,(name+"TagVarCSV_trackMomentum["+name+"nTrkTagVarCSV]/F").c_str()     );
-      tree->Branch((name+"TagVarCSV_trackEta").c_str()          ,TagVarCSV_trackEta          ,(name+"TagVarCSV_trackEta["+name+"nTrkTagVarCSV]/F").c_str()          );
-      tree->Branch((name+"TagVarCSV_trackPhi").c_str()          ,TagVarCSV_trackPhi          ,(name+"TagVarCSV_trackPhi["+name+"nTrkTagVarCSV]/F").c_str()          );
-      tree->Branch((name+"TagVarCSV_trackPtRel").c_str()        ,TagVarCSV_trackPtRel        ,(name+"TagVarCSV_trackPtRel["+name+"nTrkTagVarCSV]/F").c_str()        );
-      tree->Branch((name+"TagVarCSV_trackPPar").c_str()         ,TagVarCSV_trackPPar         ,(name+"TagVarCSV_trackPPar["+name+"nTrkTagVarCSV]/F").c_str()         );
-      tree->Branch((name+"TagVarCSV_trackDeltaR").c_str()       ,TagVarCSV_trackDeltaR       ,(name+"TagVarCSV_trackDeltaR["+name+"nTrkTagVarCSV]/F").c_str()       );
-      tree->Branch((name+"TagVarCSV_trackPtRatio").c_str()      ,TagVarCSV_trackPtRatio      ,(name+"TagVarCSV_trackPtRatio["+name+"nTrkTagVarCSV]/F").c_str()      );
-      tree->Branch((name+"TagVarCSV_trackPParRatio").c_str()    ,TagVarCSV_trackPParRatio    ,(name+"TagVarCSV_trackPParRatio["+name+"nTrkTagVarCSV]/F").c_str()    );
-      tree->Branch((name+"TagVarCSV_trackSip2dVal").c_str()     ,TagVarCSV_trackSip2dVal     ,(name+"TagVarCSV_trackSip2dVal["+name+"nTrkTagVarCSV]/F").c_str()     );
-      tree->Branch((name+"TagVarCSV_trackSip2dSig").c_str()     ,TagVarCSV_trackSip2dSig     ,(name+"TagVarCSV_trackSip2dSig["+name+"nTrkTagVarCSV]/F").c_str()     );
-      tree->Branch((name+"TagVarCSV_trackSip3dVal").c_str()     ,TagVarCSV_trackSip3dVal     ,(name+"TagVarCSV_trackSip3dVal["+name+"nTrkTagVarCSV]/F").c_str()     );
-      tree->Branch((name+"TagVarCSV_trackSip3dSig").c_str()     ,TagVarCSV_trackSip3dSig     ,(name+"TagVarCSV_trackSip3dSig["+name+"nTrkTagVarCSV]/F").c_str()     );
-      tree->Branch((name+"TagVarCSV_trackDecayLenVal").c_str()  ,TagVarCSV_trackDecayLenVal  ,(name+"TagVarCSV_trackDecayLenVal["+name+"nTrkTagVarCSV]/F").c_str()  );
-      tree->Branch((name+"TagVarCSV_trackDecayLenSig").c_str()  ,TagVarCSV_trackDecayLenSig  ,(name+"TagVarCSV_trackDecayLenSig["+name+"nTrkTagVarCSV]/F").c_str()  );
-      tree->Branch((name+"TagVarCSV_trackJetDistVal").c_str()   ,TagVarCSV_trackJetDistVal   ,(name+"TagVarCSV_trackJetDistVal["+name+"nTrkTagVarCSV]/F").c_str()   );
-      tree->Branch((name+"TagVarCSV_trackJetDistSig").c_str()   ,TagVarCSV_trackJetDistSig   ,(name+"TagVarCSV_trackJetDistSig["+name+"nTrkTagVarCSV]/F").c_str()   );
-      tree->Branch((name+"TagVarCSV_trackEtaRel").c_str()       ,TagVarCSV_trackEtaRel       ,(name+"TagVarCSV_trackEtaRel["+name+"nTrkEtaRelTagVarCSV]/F").c_str() );
+      registry_.Register(trees, name, group);
     }
 
-    void RegisterSubJetSpecificTree(TTree *tree, std::string name="") {
+    void Read(const BranchTrees & trees, std::string name, Group group) {
       if(name!="") name += ".";
-      tree->Branch((name+"Jet_FatJetIdx").c_str(),   Jet_FatJetIdx   ,(name+"Jet_FatJetIdx["+name+"nJet]/I").c_str());
+      registry_.Read(trees, name, group);
     }
 
-    void RegisterFatJetSpecificTree(TTree *tree, std::string name="") {
-      if(name!="") name += ".";
-      tree->Branch((name+"Jet_ptGroomed").c_str(),   Jet_ptGroomed   ,(name+"Jet_ptGroomed["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_jesGroomed").c_str(),  Jet_jesGroomed  ,(name+"Jet_jesGroomed["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_etaGroomed").c_str(),  Jet_etaGroomed  ,(name+"Jet_etaGroomed["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_phiGroomed").c_str(),  Jet_phiGroomed  ,(name+"Jet_phiGroomed["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_massGroomed").c_str(), Jet_massGroomed ,(name+"Jet_massGroomed["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_tau1").c_str(),        Jet_tau1        ,(name+"Jet_tau1["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_tau2").c_str(),        Jet_tau2        ,(name+"Jet_tau2["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_tau1IVF").c_str(),     Jet_tau1IVF     ,(name+"Jet_tau1IVF["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_tau2IVF").c_str(),     Jet_tau2IVF     ,(name+"Jet_tau2IVF["+name+"nJet]/F").c_str());
-      tree->Branch((name+"Jet_nSubJets").c_str(),    Jet_nSubJets    ,(name+"Jet_nSubJets["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_nFirstSJ").c_str(),    Jet_nFirstSJ    ,(name+"Jet_nFirstSJ["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_nLastSJ").c_str(),     Jet_nLastSJ     ,(name+"Jet_nLastSJ["+name+"nJet]/I").c_str());
-      tree->Branch((name+"nSubJet").c_str(),         &nSubJet        ,(name+"nSubJet/I").c_str());
-      tree->Branch((name+"SubJetIdx").c_str(),       SubJetIdx       ,(name+"SubJetIdx["+name+"nSubJet]/I").c_str());
-      tree->Branch((name+"Jet_nsharedtracks").c_str(), Jet_nsharedtracks ,(name+"Jet_nsharedtracks["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_nsubjettracks").c_str(), Jet_nsubjettracks ,(name+"Jet_nsubjettracks["+name+"nJet]/I").c_str());
-      tree->Branch((name+"Jet_nsharedsubjettracks").c_str(), Jet_nsharedsubjettracks ,(name+"Jet_nsharedsubjettracks["+name+"nJet]/I").c_str());
-    }
+    void RegisterTree(const BranchTrees & trees, std::string name="")               { Register(trees, name, Tree); }
+    void RegisterJetPFLeptonTree(const BranchTrees & trees, std::string name="")    { Register(trees, name, JetPFLeptonTree); }
+    void RegisterJetTrackTree(const BranchTrees & trees, std::string name="")       { Register(trees, name, JetTrackTree); }
+    void RegisterTagVarTree(const BranchTrees & trees, std::string name="")         { Register(trees, name, TagVarTree); }
+    void RegisterCSVTagVarTree(const BranchTrees & trees, std::string name="")      { Register(trees, name, CSVTagVarTree); }
+    void RegisterSubJetSpecificTree(const BranchTrees & trees, std::string name="") { Register(trees, name, SubJetSpecificTree); }
+    void RegisterFatJetSpecificTree(const BranchTrees & trees, std::string name="") { Register(trees, name, FatJetSpecificTree); }
 
     //------------------------------------------------------------------------------------------------------------------
 
-    void ReadTree(TTree *tree, std::string name="") {
-      if (name!="") name += ".";
-      tree->SetBranchAddress((name+"nJet").c_str(),            &nJet           );
-      tree->SetBranchAddress((name+"Jet_pt").c_str(),          Jet_pt          );
-      tree->SetBranchAddress((name+"Jet_genpt").c_str(),       Jet_genpt       );
-      tree->SetBranchAddress((name+"Jet_residual").c_str(),    Jet_residual    );
-      tree->SetBranchAddress((name+"Jet_jes").c_str(),         Jet_jes         );
-      tree->SetBranchAddress((name+"Jet_eta").c_str(),         Jet_eta         );
-      tree->SetBranchAddress((name+"Jet_phi").c_str(),         Jet_phi         );
-      tree->SetBranchAddress((name+"Jet_mass").c_str(),        Jet_mass        );
-      tree->SetBranchAddress((name+"Jet_ntracks").c_str(),     Jet_ntracks     );
-      tree->SetBranchAddress((name+"Jet_nseltracks").c_str(),  Jet_nseltracks  );
-      tree->SetBranchAddress((name+"Jet_flavour").c_str(),     Jet_flavour     );
-      tree->SetBranchAddress((name+"Jet_nbHadrons").c_str(),   Jet_nbHadrons   );
-      tree->SetBranchAddress((name+"Jet_ncHadrons").c_str(),   Jet_ncHadrons   );
-      tree->SetBranchAddress((name+"Jet_ProbaN").c_str(),      Jet_ProbaN      );
-      tree->SetBranchAddress((name+"Jet_ProbaP").c_str(),      Jet_ProbaP      );
-      tree->SetBranchAddress((name+"Jet_Proba").c_str(),       Jet_Proba       );
-      tree->SetBranchAddress((name+"Jet_BprobN").c_str(),      Jet_BprobN      );
-      tree->SetBranchAddress((name+"Jet_BprobP").c_str(),      Jet_BprobP      );
-      tree->SetBranchAddress((name+"Jet_Bprob").c_str(),       Jet_Bprob       );
-      tree->SetBranchAddress((name+"Jet_SvxN").c_str(),        Jet_SvxN        );
-      tree->SetBranchAddress((name+"Jet_Svx").c_str(),         Jet_Svx         );
-      tree->SetBranchAddress((name+"Jet_SvxNHP").c_str(),      Jet_SvxNHP      );
-      tree->SetBranchAddress((name+"Jet_SvxHP").c_str(),       Jet_SvxHP       );
-      tree->SetBranchAddress((name+"Jet_CombSvxN").c_str(),    Jet_CombSvxN    );
-      tree->SetBranchAddress((name+"Jet_CombSvxP").c_str(),    Jet_CombSvxP    );
-      tree->SetBranchAddress((name+"Jet_CombSvx").c_str(),     Jet_CombSvx     );
-
-      tree->SetBranchAddress((name+"Jet_CombIVF").c_str(),     Jet_CombIVF     );
-      tree->SetBranchAddress((name+"Jet_CombIVF_P").c_str(),   Jet_CombIVF_P   );
-      tree->SetBranchAddress((name+"Jet_CombIVF_N").c_str(),   Jet_CombIVF_N   );
-
-      tree->SetBranchAddress((name+"Jet_SoftMuN").c_str(), Jet_SoftMuN     );
-      tree->SetBranchAddress((name+"Jet_SoftMuP").c_str(), Jet_SoftMuP     );
-      tree->SetBranchAddress((name+"Jet_SoftMu").c_str(),  Jet_SoftMu      );
+    void ReadTree(const BranchTrees & trees, std::string name="")                   { Read(trees, name, Tree); }
+    void ReadJetPFLeptonTree(const BranchTrees & trees, std::string name="")        { Read(trees, name, JetPFLeptonTree); }
+    void ReadJetTrackTree(const BranchTrees & trees, std::string name="")           { Read(trees, name, JetTrackTree); }
+    void ReadTagVarTree(const BranchTrees & trees, std::string name="")             { Read(trees, name, TagVarTree); }
+    void ReadCSVTagVarTree(const BranchTrees & trees, std::string name="")          { Read(trees, name, CSVTagVarTree); }
+    void ReadSubJetSpecificTree(const BranchTrees & trees, std::string name="")     { Read(trees, name, SubJetSpecificTree); }
+    void ReadFatJetSpecificTree(const BranchTrees & trees, std::string name="")     { Read(trees, name, FatJetSpecificTree); }
 
-      tree->SetBranchAddress((name+"Jet_SoftElN").c_str(),     Jet_SoftElN     );
-      tree->SetBranchAddress((name+"Jet_SoftElP").c_str(),     Jet_SoftElP     );
-      tree->SetBranchAddress((name+"Jet_SoftEl").c_str(),      Jet_SoftEl      );
+  private :
 
-      tree->SetBranchAddress((name+"Jet_nFirstTrack").c_str(), Jet_nFirstTrack );
-      tree->SetBranchAddress((name+"Jet_nLastTrack").c_str(),  Jet_nLastTrack  );
-      tree->SetBranchAddress((name+"Jet_nFirstSV").c_str(),    Jet_nFirstSV    );
-      tree->SetBranchAddress((name+"Jet_nLastSV").c_str(),     Jet_nLastSV     );
-      tree->SetBranchAddress((name+"Jet_SV_multi").c_str(),    Jet_SV_multi      );
+    JetInfoBranches(const JetInfoBranches&);
+    JetInfoBranches & operator=(const JetInfoBranches&);
 
-      tree->SetBranchAddress((name+"Jet_looseID").c_str(),     Jet_looseID);
-      tree->SetBranchAddress((name+"Jet_tightID").c_str(),     Jet_tightID);
-
-      //--------------------------------------
-      // secondary vertex information
-      //--------------------------------------
-      tree->SetBranchAddress((name+"nSV").c_str()                ,&nSV               ) ;
-      tree->SetBranchAddress((name+"SV_x").c_str()               ,SV_x                     ) ;
-      tree->SetBranchAddress((name+"SV_y").c_str()               ,SV_y                     ) ;
-      tree->SetBranchAddress((name+"SV_z").c_str()               ,SV_z                     ) ;
-      tree->SetBranchAddress((name+"SV_ex").c_str()              ,SV_ex                  ) ;
-      tree->SetBranchAddress((name+"SV_ey").c_str()              ,SV_ey                  ) ;
-      tree->SetBranchAddress((name+"SV_ez").c_str()              ,SV_ez                  ) ;
-      tree->SetBranchAddress((name+"SV_chi2").c_str()            ,SV_chi2            ) ;
-      tree->SetBranchAddress((name+"SV_ndf").c_str()             ,SV_ndf                 ) ;
-      tree->SetBranchAddress((name+"SV_flight").c_str()          ,SV_flight          ) ;
-      tree->SetBranchAddress((name+"SV_flightErr").c_str()       ,SV_flightErr       ) ;
-      tree->SetBranchAddress((name+"SV_deltaR_jet").c_str()      ,SV_deltaR_jet      ) ;
-      tree->SetBranchAddress((name+"SV_deltaR_sum_jet").c_str()  ,SV_deltaR_sum_jet  ) ;
-      tree->SetBranchAddress((name+"SV_deltaR_sum_dir").c_str()  ,SV_deltaR_sum_dir  ) ;
-      tree->SetBranchAddress((name+"SV_vtx_pt").c_str()          ,SV_vtx_pt          ) ;
-      tree->SetBranchAddress((name+"SV_flight2D").c_str()        ,SV_flight2D        ) ;
-      tree->SetBranchAddress((name+"SV_flight2DErr").c_str()     ,SV_flight2DErr     ) ;
-      tree->SetBranchAddress((name+"SV_totCharge").c_str()       ,SV_totCharge       ) ;
-      tree->SetBranchAddress((name+"SV_vtxDistJetAxis").c_str()  ,SV_vtxDistJetAxis  ) ;
-      tree->SetBranchAddress((name+"SV_EnergyRatio").c_str()     ,SV_EnergyRatio     ) ;
-      tree->SetBranchAddress((name+"SV_dir_x").c_str()           ,SV_dir_x           ) ;
-      tree->SetBranchAddress((name+"SV_dir_y").c_str()           ,SV_dir_y           ) ;
-      tree->SetBranchAddress((name+"SV_dir_z").c_str()           ,SV_dir_z           ) ;
-      tree->SetBranchAddress((name+"SV_nTrk").c_str()            ,SV_nTrk            ) ;
-      tree->SetBranchAddress((name+"SV_mass").c_str()            ,SV_mass            ) ;
-      tree->SetBranchAddress((name+"SV_vtx_eta").c_str()         ,SV_vtx_eta         ) ;
-      tree->SetBranchAddress((name+"SV_vtx_phi").c_str()         ,SV_vtx_phi         ) ;
-    }
-
-    void ReadJetPFLeptonTree(TTree *tree, std::string name="") {
-      if (name!="") name += ".";
-      //--------------------------------------
-      // pf electron information
-      //--------------------------------------
-      tree->SetBranchAddress((name+"nPFElectron").c_str()         ,&nPFElectron        ) ;
-      tree->SetBranchAddress((name+"PFElectron_IdxJet").c_str()   ,PFElectron_IdxJet  ) ;
-      tree->SetBranchAddress((name+"PFElectron_pt").c_str()       ,PFElectron_pt      ) ;
-      tree->SetBranchAddress((name+"PFElectron_eta").c_str()      ,PFElectron_eta     ) ;
-      tree->SetBranchAddress((name+"PFElectron_phi").c_str()      ,PFElectron_phi     ) ;
-      tree->SetBranchAddress((name+"PFElectron_ptrel").c_str()    ,PFElectron_ptrel   ) ;
-      tree->SetBranchAddress((name+"PFElectron_deltaR").c_str()   ,PFElectron_deltaR  ) ;
-      tree->SetBranchAddress((name+"PFElectron_ratio").c_str()    ,PFElectron_ratio   ) ;
-      tree->SetBranchAddress((name+"PFElectron_ratioRel").c_str() ,PFElectron_ratioRel) ;
-      tree->SetBranchAddress((name+"PFElectron_IP").c_str()       ,PFElectron_IP      ) ;
-      tree->SetBranchAddress((name+"PFElectron_IP2D").c_str()     ,PFElectron_IP2D    ) ;
-
-      //--------------------------------------
-      // pf muon information
-      //--------------------------------------
-      tree->SetBranchAddress((name+"nPFMuon").c_str()            ,&nPFMuon            ) ;
-      tree->SetBranchAddress((name+"PFMuon_IdxJet").c_str()      ,PFMuon_IdxJet       ) ;
-      tree->SetBranchAddress((name+"PFMuon_pt").c_str()          ,PFMuon_pt           ) ;
-      tree->SetBranchAddress((name+"PFMuon_eta").c_str()         ,PFMuon_eta          ) ;
-      tree->SetBranchAddress((name+"PFMuon_phi").c_str()         ,PFMuon_phi          ) ;
-      tree->SetBranchAddress((name+"PFMuon_ptrel").c_str()       ,PFMuon_ptrel        ) ;
-      tree->SetBranchAddress((name+"PFMuon_deltaR").c_str()      ,PFMuon_deltaR       ) ;
-      tree->SetBranchAddress((name+"PFMuon_ratio").c_str()       ,PFMuon_ratio        ) ;
-      tree->SetBranchAddress((name+"PFMuon_ratioRel").c_str()    ,PFMuon_ratioRel     ) ;
-      tree->SetBranchAddress((name+"PFMuon_IP").c_str()          ,PFMuon_IP           ) ;
-      tree->SetBranchAddress((name+"PFMuon_IP2D").c_str()        ,PFMuon_IP2D         ) ;
-    }
-
-    void ReadJetTrackTree(TTree *tree, std::string name="") {
-      if (name!="") name += ".";
-      //--------------------------------------
-      // track information
-      //--------------------------------------
-      tree->SetBranchAddress((name+"nTrack").c_str()          ,&nTrack            ) ;
-      tree->SetBranchAddress((name+"Track_dxy").c_str()       ,Track_dxy          ) ;
-      tree->SetBranchAddress((name+"Track_dz").c_str()        ,Track_dz           ) ;
-      tree->SetBranchAddress((name+"Track_zIP").c_str()       ,Track_zIP          ) ;
-      tree->SetBranchAddress((name+"Track_length").c_str()    ,Track_length   ) ;
-      tree->SetBranchAddress((name+"Track_dist").c_str()      ,Track_dist     ) ;
-      tree->SetBranchAddress((name+"Track_IP2D").c_str()      ,Track_IP2D     ) ;
-      tree->SetBranchAddress((name+"Track_IP2Dsig").c_str()   ,Track_IP2Dsig  ) ;
-      tree->SetBranchAddress((name+"Track_IP2Derr").c_str()   ,Track_IP2Derr  ) ;
-      tree->SetBranchAddress((name+"Track_IP").c_str()        ,Track_IP           ) ;
-      tree->SetBranchAddress((name+"Track_IPsig").c_str()     ,Track_IPsig    ) ;
-      tree->SetBranchAddress((name+"Track_IPerr").c_str()     ,Track_IPerr    ) ;
-      tree->SetBranchAddress((name+"Track_Proba").c_str()     ,Track_Proba    ) ;
-      tree->SetBranchAddress((name+"Track_p").c_str()         ,Track_p            ) ;
-      tree->SetBranchAddress((name+"Track_pt").c_str()        ,Track_pt           ) ;
-      tree->SetBranchAddress((name+"Track_eta").c_str()       ,Track_eta          ) ;
-      tree->SetBranchAddress((name+"Track_phi").c_str()       ,Track_phi          ) ;
-      tree->SetBranchAddress((name+"Track_chi2").c_str()      ,Track_chi2     ) ;
-      tree->SetBranchAddress((name+"Track_charge").c_str()    ,Track_charge   ) ;
-      tree->SetBranchAddress((name+"Track_nHitStrip").c_str() ,Track_nHitStrip) ;
-      tree->SetBranchAddress((name+"Track_nHitPixel").c_str() ,Track_nHitPixel) ;
-      tree->SetBranchAddress((name+"Track_nHitAll").c_str()   ,Track_nHitAll  ) ;
-      tree->SetBranchAddress((name+"Track_nHitTIB").c_str()   ,Track_nHitTIB  ) ;
-      tree->SetBranchAddress((name+"Track_nHitTID").c_str()   ,Track_nHitTID  ) ;
-      tree->SetBranchAddress((name+"Track_nHitTOB").c_str()   ,Track_nHitTOB  ) ;
-      tree->SetBranchAddress((name+"Track_nHitTEC").c_str()   ,Track_nHitTEC  ) ;
-      tree->SetBranchAddress((name+"Track_nHitPXB").c_str()   ,Track_nHitPXB  ) ;
-      tree->SetBranchAddress((name+"Track_nHitPXF").c_str()   ,Track_nHitPXF  ) ;
-      tree->SetBranchAddress((name+"Track_isHitL1").c_str()   ,Track_isHitL1  ) ;
-      tree->SetBranchAddress((name+"Track_PV").c_str()        ,Track_PV       ) ;
-      tree->SetBranchAddress((name+"Track_SV").c_str()        ,Track_SV       ) ;
-      tree->SetBranchAddress((name+"Track_PVweight").c_str()  ,Track_PVweight ) ;
-      tree->SetBranchAddress((name+"Track_SVweight").c_str()  ,Track_SVweight ) ;
-      tree->SetBranchAddress((name+"Track_isfromSV").c_str()  ,Track_isfromSV ) ;
-    }
-
-    void ReadTagVarTree(TTree *tree, std::string name=""){
-      if (name!="") name += ".";
-      //--------------------------------------
-      // TagInfo TaggingVariables
-      //--------------------------------------
-      tree->SetBranchAddress((name+"Jet_nFirstTrkTagVar").c_str()  ,Jet_nFirstTrkTagVar );
-      tree->SetBranchAddress((name+"Jet_nLastTrkTagVar").c_str()   ,Jet_nLastTrkTagVar  );
-      tree->SetBranchAddress((name+"Jet_nFirstSVTagVar").c_str()   ,Jet_nFirstSVTagVar  );
-      tree->SetBranchAddress((name+"Jet_nLastSVTagVar").c_str()    ,Jet_nLastSVTagVar   );
-
-      tree->SetBranchAddress((name+"TagVar_jetNTracks").c_str()                   ,TagVar_jetNTracks                  );
-      tree->SetBranchAddress((name+"TagVar_jetNSecondaryVertices").c_str()        ,TagVar_jetNSecondaryVertices       );
-      tree->SetBranchAddress((name+"TagVar_chargedHadronEnergyFraction").c_str()  ,TagVar_chargedHadronEnergyFraction );
-      tree->SetBranchAddress((name+"TagVar_neutralHadronEnergyFraction").c_str()  ,TagVar_neutralHadronEnergyFraction );
-      tree->SetBranchAddress((name+"TagVar_photonEnergyFraction").c_str()         ,TagVar_photonEnergyFraction        );
-      tree->SetBranchAddress((name+"TagVar_electronEnergyFraction").c_str()       ,TagVar_electronEnergyFraction      );
-      tree->SetBranchAddress((name+"TagVar_muonEnergyFraction").c_str()           ,TagVar_muonEnergyFraction          );
-      tree->SetBranchAddress((name+"TagVar_chargedHadronMultiplicity").c_str()    ,TagVar_chargedHadronMultiplicity   );
-      tree->SetBranchAddress((name+"TagVar_neutralHadronMultiplicity").c_str()    ,TagVar_neutralHadronMultiplicity   );
-      tree->SetBranchAddress((name+"TagVar_photonMultiplicity").c_str()           ,TagVar_photonMultiplicity          );
-      tree->SetBranchAddress((name+"TagVar_electronMultiplicity").c_str()         ,TagVar_electronMultiplicity        );
-      tree->SetBranchAddress((name+"TagVar_muonMultiplicity").c_str()             ,TagVar_muonMultiplicity            );
-
-      tree->SetBranchAddress((name+"nTrkTagVar").c_str()               ,&nTrkTagVar             );
-      tree->SetBranchAddress((name+"TagVar_trackMomentum").c_str()     ,TagVar_trackMomentum    );
-      tree->SetBranchAddress((name+"TagVar_trackEta").c_str()          ,TagVar_trackEta         );
-      tree->SetBranchAddress((name+"TagVar_trackPhi").c_str()          ,TagVar_trackPhi         );
-      tree->SetBranchAddress((name+"TagVar_trackPtRel").c_str()        ,TagVar_trackPtRel       );
-      tree->SetBranchAddress((name+"TagVar_trackPPar").c_str()         ,TagVar_trackPPar        );
-      tree->SetBranchAddress((name+"TagVar_trackEtaRel").c_str()       ,TagVar_trackEtaRel      );
-      tree->SetBranchAddress((name+"TagVar_trackDeltaR").c_str()       ,TagVar_trackDeltaR      );
-      tree->SetBranchAddress((name+"TagVar_trackPtRatio").c_str()      ,TagVar_trackPtRatio     );
-      tree->SetBranchAddress((name+"TagVar_trackPParRatio").c_str()    ,TagVar_trackPParRatio   );
-      tree->SetBranchAddress((name+"TagVar_trackSip2dVal").c_str()     ,TagVar_trackSip2dVal    );
-      tree->SetBranchAddress((name+"TagVar_trackSip2dSig").c_str()     ,TagVar_trackSip2dSig    );
-      tree->SetBranchAddress((name+"TagVar_trackSip3dVal").c_str()     ,TagVar_trackSip3dVal    );
-      tree->SetBranchAddress((name+"TagVar_trackSip3dSig").c_str()     ,TagVar_trackSip3dSig    );
-      tree->SetBranchAddress((name+"TagVar_trackDecayLenVal").c_str()  ,TagVar_trackDecayLenVal );
-      tree->SetBranchAddress((name+"TagVar_trackDecayLenSig").c_str()  ,TagVar_trackDecayLenSig );
-      tree->SetBranchAddress((name+"TagVar_trackJetDistVal").c_str()   ,TagVar_trackJetDistVal  );
-      tree->SetBranchAddress((name+"TagVar_trackJetDistSig").c_str()   ,TagVar_trackJetDistSig  );
-      tree->SetBranchAddress((name+"TagVar_trackChi2").c_str()         ,TagVar_trackChi2        );
-      tree->SetBranchAddress((name+"TagVar_trackNTotalHits").c_str()   ,TagVar_trackNTotalHits  );
-      tree->SetBranchAddress((name+"TagVar_trackNPixelHits").c_str()   ,TagVar_trackNPixelHits  );
-
-      tree->SetBranchAddress((name+"nSVTagVar").c_str()                       ,&nSVTagVar                     );
-      tree->SetBranchAddress((name+"TagVar_vertexMass").c_str()               ,TagVar_vertexMass              );
-      tree->SetBranchAddress((name+"TagVar_vertexNTracks").c_str()            ,TagVar_vertexNTracks           );
-      tree->SetBranchAddress((name+"TagVar_vertexJetDeltaR").c_str()          ,TagVar_vertexJetDeltaR         );
-      tree->SetBranchAddress((name+"TagVar_flightDistance2dVal").c_str()      ,TagVar_flightDistance2dVal     );
-      tree->SetBranchAddress((name+"TagVar_flightDistance2dSig").c_str()      ,TagVar_flightDistance2dSig     );
-      tree->SetBranchAddress((name+"TagVar_flightDistance3dVal").c_str()      ,TagVar_flightDistance3dVal     );
-      tree->SetBranchAddress((name+"TagVar_flightDistance3dSig").c_str()      ,TagVar_flightDistance3dSig     );
-
-    }
-
-    void ReadCSVTagVarTree(TTree *tree, std::string name=""){
-      if (name!="") name += ".";
-      //--------------------------------------
-      // CSV TaggingVariables
-      //--------------------------------------
-      tree->SetBranchAddress((name+"Jet_nFirstTrkTagVarCSV").c_str()        ,Jet_nFirstTrkTagVarCSV );
-      tree->SetBranchAddress((name+"Jet_nLastTrkTagVarCSV").c_str()         ,Jet_nLastTrkTagVarCSV  );
-      tree->SetBranchAddress((name+"Jet_nFirstTrkEtaRelTagVarCSV").c_str()  ,Jet_nFirstTrkEtaRelTagVarCSV );
-      tree->SetBranchAddress((name+"Jet_nLastTrkEtaRelTagVarCSV").c_str()   ,Jet_nLastTrkEtaRelTagVarCSV  );
-
-      tree->SetBranchAddress((name+"TagVarCSV_trackJetPt").c_str()               ,TagVarCSV_trackJetPt              );
-      tree->SetBranchAddress((name+"TagVarCSV_jetNTracks").c_str()               ,TagVarCSV_jetNTracks              );
-      tree->SetBranchAddress((name+"TagVarCSV_jetNTracksEtaRel").c_str()         ,TagVarCSV_jetNTracksEtaRel        );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSumJetEtRatio").c_str()       ,TagVarCSV_trackSumJetEtRatio      );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSumJetDeltaR").c_str()        ,TagVarCSV_trackSumJetDeltaR       );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSip2dValAboveCharm").c_str()  ,TagVarCSV_trackSip2dValAboveCharm );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSip2dSigAboveCharm").c_str()  ,TagVarCSV_trackSip2dSigAboveCharm );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSip3dValAboveCharm").c_str()  ,TagVarCSV_trackSip3dValAboveCharm );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSip3dSigAboveCharm").c_str()  ,TagVarCSV_trackSip3dSigAboveCharm );
-      tree->SetBranchAddress((name+"TagVarCSV_vertexCategory").c_str()           ,TagVarCSV_vertexCategory          );
-      tree->SetBranchAddress((name+"TagVarCSV_jetNSecondaryVertices").c_str()    ,TagVarCSV_jetNSecondaryVertices   );
-      tree->SetBranchAddress((name+"TagVarCSV_vertexMass").c_str()               ,TagVarCSV_vertexMass              );
-      tree->SetBranchAddress((name+"TagVarCSV_vertexNTracks").c_str()            ,TagVarCSV_vertexNTracks           );
-      tree->SetBranchAddress((name+"TagVarCSV_vertexEnergyRatio").c_str()        ,TagVarCSV_vertexEnergyRatio       );
-      tree->SetBranchAddress((name+"TagVarCSV_vertexJetDeltaR").c_str()          ,TagVarCSV_vertexJetDeltaR         );
-      tree->SetBranchAddress((name+"TagVarCSV_flightDistance2dVal").c_str()      ,TagVarCSV_flightDistance2dVal     );
-      tree->SetBranchAddress((name+"TagVarCSV_flightDistance2dSig").c_str()      ,TagVarCSV_flightDistance2dSig     );
-      tree->SetBranchAddress((name+"TagVarCSV_flightDistance3dVal").c_str()      ,TagVarCSV_flightDistance3dVal     );
-      tree->SetBranchAddress((name+"TagVarCSV_flightDistance3dSig").c_str()      ,TagVarCSV_flightDistance3dSig     );
-
-      tree->SetBranchAddress((name+"nTrkTagVarCSV").c_str()               ,&nTrkTagVarCSV             );
-      tree->SetBranchAddress((name+"nTrkEtaRelTagVarCSV").c_str()         ,&nTrkEtaRelTagVarCSV       );
-      tree->SetBranchAddress((name+"TagVarCSV_trackMomentum").c_str()     ,TagVarCSV_trackMomentum    );
-      tree->SetBranchAddress((name+"TagVarCSV_trackEta").c_str()          ,TagVarCSV_trackEta         );
-      tree->SetBranchAddress((name+"TagVarCSV_trackPhi").c_str()          ,TagVarCSV_trackPhi         );
-      tree->SetBranchAddress((name+"TagVarCSV_trackPtRel").c_str()        ,TagVarCSV_trackPtRel       );
-      tree->SetBranchAddress((name+"TagVarCSV_trackPPar").c_str()         ,TagVarCSV_trackPPar        );
-      tree->SetBranchAddress((name+"TagVarCSV_trackDeltaR").c_str()       ,TagVarCSV_trackDeltaR      );
-      tree->SetBranchAddress((name+"TagVarCSV_trackPtRatio").c_str()      ,TagVarCSV_trackPtRatio     );
-      tree->SetBranchAddress((name+"TagVarCSV_trackPParRatio").c_str()    ,TagVarCSV_trackPParRatio   );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSip2dVal").c_str()     ,TagVarCSV_trackSip2dVal    );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSip2dSig").c_str()     ,TagVarCSV_trackSip2dSig    );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSip3dVal").c_str()     ,TagVarCSV_trackSip3dVal    );
-      tree->SetBranchAddress((name+"TagVarCSV_trackSip3dSig").c_str()     ,TagVarCSV_trackSip3dSig    );
-      tree->SetBranchAddress((name+"TagVarCSV_trackDecayLenVal").c_str()  ,TagVarCSV_trackDecayLenVal );
-      tree->SetBranchAddress((name+"TagVarCSV_trackDecayLenSig").c_str()  ,TagVarCSV_trackDecayLenSig );
-      tree->SetBranchAddress((name+"TagVarCSV_trackJetDistVal").c_str()   ,TagVarCSV_trackJetDistVal  );
-      tree->SetBranchAddress((name+"TagVarCSV_trackJetDistSig").c_str()   ,TagVarCSV_trackJetDistSig  );
-      tree->SetBranchAddress((name+"TagVarCSV_trackEtaRel").c_str()       ,TagVarCSV_trackEtaRel      );
-
-    }
-
-    void ReadSubJetSpecificTree(TTree *tree, std::string name="") {
-      if(name!="") name += ".";
-      tree->SetBranchAddress((name+"Jet_FatJetIdx").c_str(),   Jet_FatJetIdx   );
-    }
-
-    void ReadFatJetSpecificTree(TTree *tree, std::string name="") {
-      if(name!="") name += ".";
-      tree->SetBranchAddress((name+"Jet_ptGroomed").c_str(),   Jet_ptGroomed    );
-      tree->SetBranchAddress((name+"Jet_jesGroomed").c_str(),  Jet_jesGroomed   );
-      tree->SetBranchAddress((name+"Jet_etaGroomed").c_str(),  Jet_etaGroomed   );
-      tree->SetBranchAddress((name+"Jet_phiGroomed").c_str(),  Jet_phiGroomed   );
-      tree->SetBranchAddress((name+"Jet_massGroomed").c_str(), Jet_massGroomed  );
-      tree->SetBranchAddress((name+"Jet_tau1").c_str(),        Jet_tau1        );
-      tree->SetBranchAddress((name+"Jet_tau2").c_str(),        Jet_tau2        );
-      tree->SetBranchAddress((name+"Jet_tau1IVF").c_str(),     Jet_tau1IVF     );
-      tree->SetBranchAddress((name+"Jet_tau2IVF").c_str(),     Jet_tau2IVF     );
-      tree->SetBranchAddress((name+"Jet_nSubJets").c_str(),    Jet_nSubJets    );
-      tree->SetBranchAddress((name+"Jet_nFirstSJ").c_str(),    Jet_nFirstSJ    );
-      tree->SetBranchAddress((name+"Jet_nLastSJ").c_str(),     Jet_nLastSJ     );
-      tree->SetBranchAddress((name+"nSubJet").c_str(),         &nSubJet        );
-      tree->SetBranchAddress((name+"SubJetIdx").c_str(),       SubJetIdx       );
-      tree->SetBranchAddress((name+"Jet_nsharedtracks").c_str(), Jet_nsharedtracks );
-      tree->SetBranchAddress((name+"Jet_nsubjettracks").c_str(), Jet_nsubjettracks );
-      tree->SetBranchAddress((name+"Jet_nsharedsubjettracks").c_str(), Jet_nsharedsubjettracks );
-    }
+    BranchRegistry registry_;
+    std::vector<std::unique_ptr<BranchColumn<float> > > jetColumns_;
 };
 
 #endif
@@ -18,26 +18,37 @@ Implementation:
 //
 
 // system include files
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 // user include files
 #include "FWCore/Common/interface/Provenance.h"
 #include "FWCore/Framework/interface/Frameworkfwd.h"
-#include "FWCore/Framework/interface/EDAnalyzer.h"
+#include "FWCore/Framework/interface/global/EDAnalyzer.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/ESHandle.h"
+#include "FWCore/Framework/interface/ESWatcher.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "FWCore/Framework/interface/TriggerNamesService.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/Utilities/interface/Exception.h"
 #include "FWCore/Utilities/interface/RegexMatch.h"
 
 #include "DataFormats/Candidate/interface/VertexCompositePtrCandidate.h"
 #include "DataFormats/Common/interface/TriggerResults.h"
+#include "DataFormats/Provenance/interface/ParameterSetID.h"
 #include "DataFormats/BTauReco/interface/JetTag.h"
 #include "DataFormats/BTauReco/interface/CandIPTagInfo.h"
 #include "DataFormats/BTauReco/interface/TrackIPTagInfo.h"
 #include "DataFormats/BTauReco/interface/CandSoftLeptonTagInfo.h"
+#include "DataFormats/BTauReco/interface/TaggingVariable.h"
 #include "DataFormats/GeometrySurface/interface/Line.h"
 #include "DataFormats/GeometryCommonDetAlgo/interface/Measurement1D.h"
 #include "DataFormats/HepMCCandidate/interface/GenParticleFwd.h"
@@ -68,13 +79,23 @@ Implementation:
 
 #include "fastjet/contrib/Njettiness.hh"
 
+#include "Compression.h"
+#include "RVersion.h"
+#include "TBranch.h"
 #include "TFile.h"
 #include "TTree.h"
 
 #include <boost/regex.hpp>
 
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_group.h"
+
 #include "RecoBTag/BTagAnalyzerLite/interface/JetInfoBranches.h"
 #include "RecoBTag/BTagAnalyzerLite/interface/EventInfoBranches.h"
+#include "RecoBTag/BTagAnalyzerLite/interface/AsyncTreeWriter.h"
+#include "RecoBTag/BTagAnalyzerLite/interface/DeltaRMatcher.h"
+#include "RecoBTag/BTagAnalyzerLite/interface/FlatJetTree.h"
 
 //
 // constants, enums and typedefs
@@ -86,15 +107,47 @@ typedef std::vector<pat::Jet> PatJetCollection;
 // class declaration
 //
 
+// JEC factors (pat::Jet::jecFactor, i.e. corrected pt / current pt) of each jet of a collection at the levels read by
+// the analyzer, filled once per event so that no corrected copy of the jets (pat::Jet::correctedJet) has to be made;
+// the factors are 1 for jets without JEC sets
+struct BTagAnalyzerLiteJECFactors
+{
+  enum Level { Uncorrected, L3Absolute, nLevels };
+
+  // computes the levels up to (and including) lastLevel
+  void fill(const PatJetCollection & jets, Level lastLevel)
+  {
+    static const std::string names[nLevels] = { "Uncorrected", "L3Absolute" };
+
+    factors.assign(jets.size()*nLevels, 1.f);
+    jecSets.assign(jets.size(), false);
+    for(size_t i=0; i<jets.size(); ++i)
+    {
+      if( !jets[i].jecSetsAvailable() ) continue;
+
+      jecSets[i] = true;
+      for(int level=0; level<=lastLevel; ++level) factors[i*nLevels + level] = jets[i].jecFactor(names[level]);
+    }
+  }
+
+  bool available(size_t iJet) const { return jecSets[iJet]; }
+
+  float operator()(size_t iJet, Level level) const { return factors[iJet*nLevels + level]; }
+
+  std::vector<float> factors;
+  std::vector<bool> jecSets;
+};
+
+// orders jets of a collection by decreasing pt at the given correction level
 struct orderByPt {
-    const std::string mCorrLevel;
-    orderByPt(const std::string& fCorrLevel) : mCorrLevel(fCorrLevel) {}
-    bool operator ()(PatJetCollection::const_iterator const& a, PatJetCollection::const_iterator const& b) {
-      if( mCorrLevel=="Uncorrected" )
-        return a->correctedJet("Uncorrected").pt() > b->correctedJet("Uncorrected").pt();
-      else
-        return a->pt() > b->pt();
+    orderByPt(PatJetCollection::const_iterator begin, const BTagAnalyzerLiteJECFactors& jec, BTagAnalyzerLiteJECFactors::Level level) :
+      mBegin(begin), mJEC(jec), mLevel(level) {}
+    bool operator ()(PatJetCollection::const_iterator const& a, PatJetCollection::const_iterator const& b) const {
+      return a->pt()*mJEC(a - mBegin, mLevel) > b->pt()*mJEC(b - mBegin, mLevel);
     }
+    PatJetCollection::const_iterator mBegin;
+    const BTagAnalyzerLiteJECFactors & mJEC;
+    BTagAnalyzerLiteJECFactors::Level mLevel;
 };
 
 const math::XYZPoint & position(const reco::Vertex & sv) {return sv.position();}
@@ -114,8 +167,482 @@ const unsigned int nTracks(const reco::VertexCompositePtrCandidate & sv) {return
 
 const UInt_t MAX_JETCOLLECTIONS=2;
 
+// the trees of all BTagAnalyzerLite instances (and their background writers) live in the one TFileService file,
+// so every operation that writes to it (branch creation, TTree::Fill, FlushBaskets, ...) is done under this lock
+std::mutex & outputFileMutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+// number of entries in each of the variable-length JetInfoBranches arrays
+struct JetInfoOffsets
+{
+  JetInfoOffsets() :
+    nJet(0), nTrack(0), nSV(0), nPFElectron(0), nPFMuon(0),
+    nTrkTagVar(0), nSVTagVar(0), nTrkTagVarCSV(0), nTrkEtaRelTagVarCSV(0), nSubJet(0)
+  {}
+
+  JetInfoOffsets & operator+=(const JetInfoOffsets & other)
+  {
+    nJet                += other.nJet;
+    nTrack              += other.nTrack;
+    nSV                 += other.nSV;
+    nPFElectron         += other.nPFElectron;
+    nPFMuon             += other.nPFMuon;
+    nTrkTagVar          += other.nTrkTagVar;
+    nSVTagVar           += other.nSVTagVar;
+    nTrkTagVarCSV       += other.nTrkTagVarCSV;
+    nTrkEtaRelTagVarCSV += other.nTrkEtaRelTagVarCSV;
+    nSubJet             += other.nSubJet;
+    return *this;
+  }
+
+  int nJet;
+  int nTrack;
+  int nSV;
+  int nPFElectron;
+  int nPFMuon;
+  int nTrkTagVar;
+  int nSVTagVar;
+  int nTrkTagVarCSV;
+  int nTrkEtaRelTagVarCSV;
+  int nSubJet;
+};
+
+// TagInfos of a jet, looked up by label once per jet (in prepareJet) and reused for the jet and, through the
+// records of the subjet collection, for the subjets of the fat jets; the IP and SV TagInfos are kept as their
+// base class, see BTagAnalyzerLiteT::toIPTagInfo/toSVTagInfo
+struct JetTagInfos
+{
+  JetTagInfos() : ip(0), sv(0), softPFMu(0), softPFEl(0) {}
+
+  const reco::BaseTagInfo * ip;
+  const reco::BaseTagInfo * sv;
+  const reco::CandSoftLeptonTagInfo * softPFMu;
+  const reco::CandSoftLeptonTagInfo * softPFEl;
+};
+
+// per-jet bookkeeping: whether the jet is stored, how many entries it adds and where they start
+struct JetRecord
+{
+  JetRecord() : selected(false) {}
+
+  bool selected;
+  JetTagInfos tagInfos;
+  JetInfoOffsets counts;
+  JetInfoOffsets first;
+  reco::TaggingVariableList csvVars;
+};
+
+// copies the values of a TaggingVariableList to the JetInfoBranches columns in a single pass over the list, through a
+// table from tag to destination built once: either a per-jet column (first value of the tag, a default if the tag is
+// missing) or a column of one of the blocks of per-jet entries (the i-th value of the tag goes to the i-th entry of the
+// jet in the block, values beyond the number of entries of the jet are dropped). Like getList it relies on the list being
+// sorted by tag, the values of a tag being kept in the order they were added.
+class BTagAnalyzerLiteTagVarExtractor
+{
+  public:
+    typedef BranchColumn<float> JetInfoBranches::* Column;
+
+    BTagAnalyzerLiteTagVarExtractor() : destinations(reco::btau::lastTaggingVariable + 1, -1) {}
+
+    void addJetVariable(reco::btau::TaggingVariableName tag, Column column, float missing)
+    {
+      add(tag, column, -1, missing);
+    }
+
+    void addBlockVariable(reco::btau::TaggingVariableName tag, Column column, int block)
+    {
+      add(tag, column, block, 0.f);
+    }
+
+    // first[b] and length[b] are the first entry and the number of entries of the jet in block b
+    void extract(const reco::TaggingVariableList & vars, JetInfoBranches & jetInfo, int iJet, const int * first, const int * length) const
+    {
+      for(std::vector<Destination>::const_iterator it=jetVariables.begin(); it!=jetVariables.end(); ++it)
+        (jetInfo.*(it->column))[iJet] = it->missing;
+
+      int previous = -1;
+      int n = 0;      // number of values of the current tag seen before
+      for(reco::TaggingVariableList::const_iterator it=vars.begin(); it!=vars.end(); ++it)
+      {
+        const int tag = it->first;
+        n = ( tag == previous ? n+1 : 0 );
+        previous = tag;
+        if( tag < 0 || tag >= int(destinations.size()) || destinations[tag] < 0 ) continue;
+
+        const Destination & dest = table[destinations[tag]];
+        if( dest.block < 0 )
+        {
+          if( n == 0 ) (jetInfo.*(dest.column))[iJet] = it->second;
+        }
+        else if( n < length[dest.block] )
+          (jetInfo.*(dest.column))[first[dest.block] + n] = it->second;
+      }
+    }
+
+    // number of values of a tag, without copying them
+    static int count(const reco::TaggingVariableList & vars, reco::btau::TaggingVariableName tag)
+    {
+      reco::TaggingVariableList::const_iterator begin =
+        std::lower_bound(vars.begin(), vars.end(), tag, [](const reco::TaggingVariable & var, reco::btau::TaggingVariableName t) { return var.first < t; });
+      reco::TaggingVariableList::const_iterator end =
+        std::upper_bound(begin, vars.end(), tag, [](reco::btau::TaggingVariableName t, const reco::TaggingVariable & var) { return t < var.first; });
+      return end - begin;
+    }
+
+  private:
+    struct Destination
+    {
+      Column column;
+      int block;      // -1 for per-jet columns
+      float missing;
+    };
+
+    void add(reco::btau::TaggingVariableName tag, Column column, int block, float missing)
+    {
+      if( destinations[tag] >= 0 )
+        throw cms::Exception("LogicError") << "TaggingVariable " << reco::TaggingVariableTokens[tag] << " is mapped to more than one branch\n";
+
+      const Destination dest = { column, block, missing };
+      destinations[tag] = table.size();
+      table.push_back(dest);
+      if( block < 0 ) jetVariables.push_back(dest);
+    }
+
+    std::vector<int> destinations;          // index in table of each tag, -1 if the tag is not stored
+    std::vector<Destination> table;
+    std::vector<Destination> jetVariables;
+};
+
+// product and index of a reference (Ref, RefToBase or Ptr), i.e. what the reference comparisons look at
+template<typename Ref>
+inline uint64_t productRefKey(const Ref & ref)
+{
+  return ( uint64_t(ref.id().processIndex()) << 48 ) | ( uint64_t(ref.id().productIndex()) << 32 ) | uint32_t(ref.key());
+}
+
+// vertex of each track used in a set of vertex fits: the vertex in which the track has the highest weight (the first one
+// in case of a tie), built once (per event for the primary vertices, per jet for the secondary vertices) so that the
+// tracks are then looked up in constant time
+struct BTagAnalyzerLiteTrackVertexMap
+{
+  void clear() { bestVertex.clear(); }
+
+  template<typename Ref>
+  void add(const Ref & ref, int iVertex, float weight)
+  {
+    if( !(weight > 0.f) ) return;
+
+    std::pair<std::unordered_map<uint64_t, std::pair<int,float> >::iterator, bool> inserted =
+      bestVertex.insert( std::make_pair(productRefKey(ref), std::make_pair(iVertex, weight)) );
+    if( !inserted.second && weight > inserted.first->second.second ) inserted.first->second = std::make_pair(iVertex, weight);
+  }
+
+  void add(const reco::Vertex & vtx, int iVertex)
+  {
+    for(reco::Vertex::trackRef_iterator it=vtx.tracks_begin(); it!=vtx.tracks_end(); ++it)
+      add(*it, iVertex, vtx.trackWeight(*it));
+  }
+
+  // reco::VertexCompositePtrCandidate does not store track weights, every daughter gets weight 1 (so the first vertex wins)
+  void add(const reco::VertexCompositePtrCandidate & vtx, int iVertex)
+  {
+    const std::vector<reco::CandidatePtr> & tracks = vtx.daughterPtrVector();
+    for(std::vector<reco::CandidatePtr>::const_iterator it=tracks.begin(); it!=tracks.end(); ++it)
+      add(*it, iVertex, 1.f);
+  }
+
+  void fill(const reco::VertexCollection & vertices)
+  {
+    clear();
+    for(size_t iv=0; iv<vertices.size(); ++iv) add(vertices[iv], iv);
+  }
+
+  template<typename SVTagInfo>
+  void fillSV(const SVTagInfo & svTagInfo)
+  {
+    clear();
+    for(size_t iv=0; iv<svTagInfo.nVertices(); ++iv) add(svTagInfo.secondaryVertex(iv), iv);
+  }
+
+  template<typename Ref>
+  bool contains(const Ref & ref) const { return bestVertex.count(productRefKey(ref)) != 0; }
+
+  // iVertex = -1 and weight = 0 for tracks not used in any of the vertex fits
+  template<typename Ref>
+  void find(const Ref & ref, int & iVertex, float & weight) const
+  {
+    std::unordered_map<uint64_t, std::pair<int,float> >::const_iterator it = bestVertex.find(productRefKey(ref));
+    iVertex = ( it != bestVertex.end() ? it->second.first : -1 );
+    weight  = ( it != bestVertex.end() ? it->second.second : 0. );
+  }
+
+  std::unordered_map<uint64_t, std::pair<int,float> > bestVertex;
+};
+
+// links between the subjets and the fat jets, built once per event from the daughters of the groomed fat jets
+// (matched to the subjets through the original object of the subjets)
+struct BTagAnalyzerLiteSubJetTable
+{
+  template<typename Jets>
+  void fill(const Jets & subjets, const Jets & groomedFatJets, const std::vector<int> & groomedIndices)
+  {
+    // subjet of each original object (the first one if several subjets share it)
+    std::unordered_map<uint64_t, int> subjetOfObject;
+    for(size_t sj=0; sj<subjets.size(); ++sj)
+      subjetOfObject.insert( std::make_pair(productRefKey(subjets[sj].originalObjectRef()), int(sj)) );
+
+    // fat jet of each original subjet object (the first fat jet that has it among its groomed daughters)
+    std::unordered_map<uint64_t, int> fatJetOfObject;
+    subJets.resize(groomedIndices.size());
+    for(size_t fj=0; fj<groomedIndices.size(); ++fj)
+    {
+      subJets[fj].clear();
+      if( groomedIndices[fj] < 0 ) continue;
+
+      const edm::Ptr<reco::Jet> originalObjRef = edm::Ptr<reco::Jet>( groomedFatJets[groomedIndices[fj]].originalObjectRef() );
+      const size_t nSJ = groomedFatJets[groomedIndices[fj]].numberOfDaughters();
+      for(size_t sjIt=0; sjIt<nSJ; ++sjIt)
+      {
+        const uint64_t key = productRefKey( originalObjRef->daughterPtr(sjIt) );
+        std::unordered_map<uint64_t, int>::const_iterator it = subjetOfObject.find(key);
+        subJets[fj].push_back( it != subjetOfObject.end() ? it->second : -1 );
+        fatJetOfObject.insert( std::make_pair(key, int(fj)) );
+      }
+    }
+
+    fatJet.assign(subjets.size(), -1);
+    for(size_t sj=0; sj<subjets.size(); ++sj)
+    {
+      std::unordered_map<uint64_t, int>::const_iterator it = fatJetOfObject.find( productRefKey(subjets[sj].originalObjectRef()) );
+      if( it != fatJetOfObject.end() ) fatJet[sj] = it->second;
+    }
+  }
+
+  std::vector<int> fatJet;                 // fat jet of each subjet, -1 if none
+  std::vector<std::vector<int> > subJets;  // subjet of each groomed daughter of each fat jet, -1 if not found
+};
+
+// tools that keep internal state while evaluating a jet, one copy per thread
+struct BTagAnalyzerLiteJetTools
+{
+  BTagAnalyzerLiteJetTools() :
+    pfjetIDLoose( PFJetIDSelectionFunctor::FIRSTDATA, PFJetIDSelectionFunctor::LOOSE ),
+    pfjetIDTight( PFJetIDSelectionFunctor::FIRSTDATA, PFJetIDSelectionFunctor::TIGHT ),
+    njettiness(fastjet::contrib::OnePass_KT_Axes(), fastjet::contrib::NormalizedMeasure(1.0,0.8))
+  {}
+
+  // PF jet ID
+  PFJetIDSelectionFunctor pfjetIDLoose;
+  PFJetIDSelectionFunctor pfjetIDTight;
+
+  // N-subjettiness calculator
+  fastjet::contrib::Njettiness njettiness;
+
+  // secondary vertex of the tracks of the jet being filled
+  BTagAnalyzerLiteTrackVertexMap trackSVs;
+};
+
+// keep/drop patterns on the output branch names ("keep <glob>" or "drop <glob>"), applied in order like the
+// outputCommands of an output module: the last matching pattern decides and branches are kept by default
+struct BTagAnalyzerLiteBranchSelection
+{
+  std::vector<std::pair<bool,boost::regex> > patterns;
+
+  bool operator()(const std::string & branch) const
+  {
+    bool keep = true;
+    for(std::vector<std::pair<bool,boost::regex> >::const_iterator it = patterns.begin(); it != patterns.end(); ++it)
+      if( boost::regex_match(branch, it->second) ) keep = it->first;
+    return keep;
+  }
+
+  static BTagAnalyzerLiteBranchSelection parse(const std::vector<std::string> & commands, const std::string & parameter)
+  {
+    BTagAnalyzerLiteBranchSelection selection;
+    for(std::vector<std::string>::const_iterator it = commands.begin(); it != commands.end(); ++it)
+    {
+      std::istringstream command(*it);
+      std::string action, pattern, rest;
+      command >> action >> pattern;
+      if( ( action != "keep" && action != "drop" ) || pattern.empty() || ( command >> rest ) )
+        throw cms::Exception("Configuration") << "Invalid " << parameter << " entry '" << *it << "', expected 'keep <pattern>' or 'drop <pattern>'";
+      selection.patterns.push_back( std::make_pair( action == "keep", boost::regex(edm::glob2reg(pattern)) ) );
+    }
+    return selection;
+  }
+};
+
+// reduced precision of the output float branches ("<glob> <mantissa bits>"), the last matching pattern decides
+struct BTagAnalyzerLiteBranchPrecision
+{
+  std::vector<std::pair<int,boost::regex> > patterns;
+
+  int operator()(const std::string & branch) const
+  {
+    int mantissaBits = -1;
+    for(std::vector<std::pair<int,boost::regex> >::const_iterator it = patterns.begin(); it != patterns.end(); ++it)
+      if( boost::regex_match(branch, it->second) ) mantissaBits = it->first;
+    return mantissaBits;
+  }
+};
+
+// I/O settings of a group of output branches (the default group matches every branch)
+struct BTagAnalyzerLiteIOGroup
+{
+  std::string name;
+  std::vector<boost::regex> branches;
+  int compressionSettings;  // 100*algorithm + level, -1 to keep the ROOT default
+  int basketSize;           // in bytes, -1 to keep the ROOT default
+
+  // TTree::GetTotBytes / TTree::GetZipBytes summed over the branches of the group (reported in endJob)
+  Long64_t totBytes;
+  Long64_t zipBytes;
+};
+
+// discriminator stored for each jet: pat::Jet::bDiscriminator label and float nJet branch (discriminators)
+struct BTagAnalyzerLiteDiscriminator
+{
+  std::string label;
+  std::string branch;
+};
+
+// optional per-jet computations of a jet collection, only done if at least one of the branches they fill is stored
+struct BTagAnalyzerLiteJetDemand
+{
+  BTagAnalyzerLiteJetDemand() : tracksPV(true), tracksSV(true), svJetAxisDistance(true), nsubjettinessIVF(true), csvTagVariables(true) {}
+
+  bool tracksPV;          // setTracksPV: Track_PV, Track_PVweight and (through the track kinematics) SV_EnergyRatio
+  bool tracksSV;          // setTracksSV: Track_isfromSV, Track_SV, Track_SVweight
+  bool svJetAxisDistance; // SV_vtxDistJetAxis
+  bool nsubjettinessIVF;  // recalcNsubjettiness: Jet_tau1IVF, Jet_tau2IVF
+  bool csvTagVariables;   // CSV TaggingVariables (computer->taggingVariables): the *TagVarCSV* branches
+
+  // stored discriminator branches: index in the discriminators table (and in BTagAnalyzerLiteBuffers::discriminatorColumns)
+  std::vector<size_t> discriminators;
+};
+
+// one set of ntuple buffers, i.e. the content of one entry of the output tree
+struct BTagAnalyzerLiteBuffers
+{
+  // the discriminators fill the schema column of their branch, branches not in the schema are added to it in the order of the table
+  explicit BTagAnalyzerLiteBuffers(const std::vector<BTagAnalyzerLiteDiscriminator> & discriminators)
+  {
+    for(UInt_t i=0; i<MAX_JETCOLLECTIONS; ++i)
+      for(std::vector<BTagAnalyzerLiteDiscriminator>::const_iterator it = discriminators.begin(); it != discriminators.end(); ++it)
+      {
+        BranchColumn<float> * column = &JetInfo[i].JetColumn(it->branch);
+        if( std::find(discriminatorColumns[i].begin(), discriminatorColumns[i].end(), column) != discriminatorColumns[i].end() )
+          throw std::invalid_argument("branch " + it->branch + " is filled by more than one discriminator");
+        discriminatorColumns[i].push_back(column);
+      }
+
+    eventCounters = counterValues(EventInfo.Counters());
+    for(UInt_t i=0; i<MAX_JETCOLLECTIONS; ++i) jetCounters[i] = counterValues(JetInfo[i].Counters());
+  }
+
+  static std::vector<const int*> counterValues(const std::vector<std::pair<std::string,const int*> > & counters)
+  {
+    std::vector<const int*> values;
+    for(size_t i=0; i<counters.size(); ++i) values.push_back(counters[i].second);
+    return values;
+  }
+
+  //// Event info
+  EventInfoBranches EventInfo;
+
+  //// Jet info
+  JetInfoBranches JetInfo[MAX_JETCOLLECTIONS] ;
+
+  // column filled by each entry of the discriminators table
+  std::vector<BranchColumn<float>*> discriminatorColumns[MAX_JETCOLLECTIONS];
+
+  // counters of the columns (in the order of Counters()), looked up once per buffer set for the high-water marks
+  std::vector<const int*> eventCounters;
+  std::vector<const int*> jetCounters[MAX_JETCOLLECTIONS];
+
+  // grows the columns to the current counters, returns true if the branches have to be bound again
+  bool Fit()
+  {
+    bool moved = EventInfo.Fit();
+    for(UInt_t i=0; i<MAX_JETCOLLECTIONS; ++i) moved |= JetInfo[i].Fit();
+    return moved;
+  }
+};
+
+// per-stream state: ntuple buffers and everything that is modified while processing an event
+struct BTagAnalyzerLiteStreamCache
+{
+  explicit BTagAnalyzerLiteStreamCache(BTagAnalyzerLiteBuffers * buffers) :
+    buffers(buffers),
+    dummyPV(reco::Vertex::Point(0,0,0), dummyPVError(), 1, 1, 1),
+    pv(0),
+    computer(0),
+    jetComputer(0),
+    fatJetComputer(0),
+    isData(false)
+  {
+    for(UInt_t i=0; i<MAX_JETCOLLECTIONS; ++i) discriminatorLayoutChanged[i] = true;
+  }
+
+  static reco::Vertex::Error dummyPVError()
+  {
+    reco::Vertex::Error e;
+    e(0,0)=0.0015*0.0015;
+    e(1,1)=0.0015*0.0015;
+    e(2,2)=15.*15.;
+    return e;
+  }
+
+  // ntuple buffers of the event being processed (swapped with a free set when handed to the background writer)
+  std::unique_ptr<BTagAnalyzerLiteBuffers> buffers;
+
+  edm::Handle<reco::VertexCollection> primaryVertex;
+
+  // JEC factors of the jets, fat jets and groomed fat jets of the event
+  BTagAnalyzerLiteJECFactors jecFactors[MAX_JETCOLLECTIONS+1];
+
+  // subjet <-> fat jet links of the event (only with runSubJets)
+  BTagAnalyzerLiteSubJetTable subJetTable;
+
+  // best primary vertex of the vertex tracks (only filled when Track_PV or Track_PVweight is stored)
+  BTagAnalyzerLiteTrackVertexMap trackPVs;
+
+  // used in place of the primary vertex in events without one
+  const reco::Vertex dummyPV;
+
+  const reco::Vertex *pv;
+  const GenericMVAJetTagComputer *computer;  // of the jet collection being processed
+
+  // jet tag computers of the jets and fat jets, fetched again only when the JetTagComputerRecord changes
+  edm::ESWatcher<JetTagComputerRecord> computerWatcher;
+  const GenericMVAJetTagComputer *jetComputer;
+  const GenericMVAJetTagComputer *fatJetComputer;
+
+  bool isData;
+
+  // trigger bit masks of each path of the trigger menu identified by triggerNamesID (TriggerPathNames
+  // patterns matched by the path, nBitTrigger words per path), rebuilt when the menu changes
+  edm::ParameterSetID triggerNamesID;
+  std::vector<int> triggerMasks;
+
+  // per-jet bookkeeping reused from event to event
+  std::vector<JetRecord> jetRecords[MAX_JETCOLLECTIONS];
+
+  // position of each stored discriminator (see BTagAnalyzerLiteJetDemand::discriminators) in pat::Jet::getPairDiscri,
+  // taken from the first jet of the collection and kept from event to event; jets with a different layout fall back to
+  // bDiscriminator and flag the layout change, so that the positions are resolved again in the next event
+  std::vector<size_t> discriminatorIndices[MAX_JETCOLLECTIONS];
+  std::atomic<bool> discriminatorLayoutChanged[MAX_JETCOLLECTIONS];
+
+  // PF jet ID selectors and N-subjettiness calculator (they keep internal state so each thread needs its own copy)
+  tbb::enumerable_thread_specific<BTagAnalyzerLiteJetTools> jetTools;
+};
+
 template<typename IPTI,typename VTX>
-class BTagAnalyzerLiteT : public edm::EDAnalyzer
+class BTagAnalyzerLiteT : public edm::global::EDAnalyzer<edm::StreamCache<BTagAnalyzerLiteStreamCache> >
 {
   public:
     explicit BTagAnalyzerLiteT(const edm::ParameterSet&);
@@ -125,37 +652,74 @@ class BTagAnalyzerLiteT : public edm::EDAnalyzer
     typedef typename IPTI::input_container::value_type TrackRef;
     typedef VTX Vertex;
     typedef reco::TemplatedSecondaryVertexTagInfo<IPTI,VTX> SVTagInfo;
+    typedef BTagAnalyzerLiteStreamCache StreamCache;
+    typedef BTagAnalyzerLiteBuffers Buffers;
 
   private:
     virtual void beginJob() ;
-    virtual void analyze(const edm::Event&, const edm::EventSetup&);
+    virtual std::unique_ptr<StreamCache> beginStream(edm::StreamID) const;
+    virtual void analyze(edm::StreamID, const edm::Event&, const edm::EventSetup&) const;
     virtual void endJob() ;
 
-    const IPTagInfo * toIPTagInfo(const pat::Jet & jet, const std::string & tagInfos);
-    const SVTagInfo * toSVTagInfo(const pat::Jet & jet, const std::string & tagInfos);
+    void registerBranches(Buffers&) const;
+    void bindBranches(Buffers&) const;
+    void fillTree(StreamCache&) const;
+    void fillTree(Buffers&) const;
+    void updateHighWaterMarks(const Buffers&) const;
+    void truncateBranches(Buffers&) const;
+    TTree * makeTree(const char * name);
+    bool jetGroupFilled(int iJetColl, JetInfoBranches::Group group) const;
+    void configureIO() const;
+
+    const IPTagInfo * toIPTagInfo(const pat::Jet & jet, const std::string & tagInfos) const;
+    const SVTagInfo * toSVTagInfo(const pat::Jet & jet, const std::string & tagInfos) const;
 
-    void setTracksPVBase(const reco::TrackRef & trackRef, const edm::Handle<reco::VertexCollection> & pvHandle, int & iPV, float & PVweight);
-    void setTracksPV(const TrackRef & trackRef, const edm::Handle<reco::VertexCollection> & pvHandle, int & iPV, float & PVweight);
+    void resolveTagInfos(const pat::Jet & jet, JetTagInfos & tagInfos) const;
+    const IPTagInfo * toIPTagInfo(const JetTagInfos & tagInfos) const { return static_cast<const IPTagInfo*>(tagInfos.ip); }
+    const SVTagInfo * toSVTagInfo(const JetTagInfos & tagInfos) const { return static_cast<const SVTagInfo*>(tagInfos.sv); }
 
-    void setTracksSV(const TrackRef & trackRef, const SVTagInfo *, int & isFromSV, int & iSV, float & SVweight);
+    void setTracksPVBase(const reco::TrackRef & trackRef, const BTagAnalyzerLiteTrackVertexMap & trackPVs, int & iPV, float & PVweight) const;
+    void setTracksPV(const TrackRef & trackRef, const BTagAnalyzerLiteTrackVertexMap & trackPVs, int & iPV, float & PVweight) const;
 
-    void vertexKinematicsAndChange(const Vertex & vertex, reco::TrackKinematics & vertexKinematics, Int_t & charge);
+    void setTracksSV(const TrackRef & trackRef, const BTagAnalyzerLiteTrackVertexMap & trackSVs, int & isFromSV, int & iSV, float & SVweight) const;
 
-    bool NameCompatible(const std::string& pattern, const std::string& name);
+    void vertexKinematicsAndChange(const Vertex & vertex, reco::TrackKinematics & vertexKinematics, Int_t & charge) const;
 
-    void processTrig(const edm::Handle<edm::TriggerResults>&, const std::vector<std::string>&) ;
+    Buffers * makeBuffers() const;
+
+    void updateTriggerMasks(const edm::TriggerResults&, StreamCache&) const;
+    const GenericMVAJetTagComputer * getComputer(const edm::EventSetup&, const std::string&) const;
+
+    void processGen(const edm::Handle<GenEventInfoProduct>&, const edm::Handle<std::vector<PileupSummaryInfo> >&,
+                    const edm::Handle<reco::GenParticleCollection>&, EventInfoBranches&) const;
+
+    void processMuons(const edm::Handle<std::vector<pat::Muon> >&, EventInfoBranches&) const;
+
+    void processPV(StreamCache&) const;
+
+    void processTrig(const edm::Handle<edm::TriggerResults>&, const std::vector<int>&, EventInfoBranches&) const;
 
     void processJets(const edm::Handle<PatJetCollection>&, const edm::Handle<PatJetCollection>&,
                      const edm::Event&, const edm::EventSetup&,
-                     const edm::Handle<PatJetCollection>&, std::vector<int>&, const int) ;
+                     const edm::Handle<PatJetCollection>&, std::vector<int>&, const int, StreamCache&) const;
+
+    void prepareJet(const edm::Handle<PatJetCollection>&, const edm::Handle<PatJetCollection>&,
+                    const std::vector<int>&, const size_t, const int, const StreamCache&, JetRecord&) const;
 
-    void recalcNsubjettiness(const pat::Jet & jet, const SVTagInfo & svTagInfo, float & tau1, float & tau2);
+    void fillJet(const edm::Handle<PatJetCollection>&, const edm::Handle<PatJetCollection>&,
+                 const edm::Handle<PatJetCollection>&, const std::vector<int>&,
+                 const size_t, const int, const JetRecord&, StreamCache&) const;
 
-    bool isHardProcess(const int status);
+    void recalcNsubjettiness(const pat::Jet & jet, const SVTagInfo & svTagInfo, const BTagAnalyzerLiteTrackVertexMap & trackSVs,
+                             fastjet::contrib::Njettiness & njettiness, float & tau1, float & tau2) const;
+
+    bool isHardProcess(const int status) const;
+
+    void setupTagVarExtractors();
 
     void matchGroomedJets(const edm::Handle<PatJetCollection>& jets,
                           const edm::Handle<PatJetCollection>& matchedJets,
-                          std::vector<int>& matchedIndices);
+                          std::vector<int>& matchedIndices) const;
 
     // ----------member data ---------------------------
     std::string outputFile_;
@@ -169,25 +733,27 @@ class BTagAnalyzerLiteT : public edm::EDAnalyzer
     bool storeMuonInfo_;
     bool storeTagVariables_;
     bool storeCSVTagVariables_;
-
-    edm::InputTag src_;  // Generator/handronizer module label
-    edm::InputTag muonCollectionName_;
-    edm::InputTag prunedGenParticleCollectionName_;
-    edm::InputTag triggerTable_;
-
-    edm::InputTag JetCollectionTag_;
-    edm::InputTag FatJetCollectionTag_;
-    edm::InputTag GroomedFatJetCollectionTag_;
-
-    edm::InputTag primaryVertexColl_;
-
-    std::string jetPBJetTags_;
-    std::string jetPNegBJetTags_;
-    std::string jetPPosBJetTags_;
-
-    std::string jetBPBJetTags_;
-    std::string jetBPNegBJetTags_;
-    std::string jetBPPosBJetTags_;
+    BTagAnalyzerLiteTagVarExtractor ipTagVars_;    // track variables of the IP TagInfo (block 0: tracks)
+    BTagAnalyzerLiteTagVarExtractor svTagVars_;    // vertex variables of the SV TagInfo (block 0: SVs)
+    BTagAnalyzerLiteTagVarExtractor csvTagVars_;   // CSV variables (block 0: tracks, block 1: tracks with etaRel)
+    bool parallelJetProcessing_;
+    bool asyncTreeFilling_;
+    bool splitTrees_;
+    BTagAnalyzerLiteBranchSelection branchSelection_;
+    BTagAnalyzerLiteBranchPrecision branchPrecision_;
+
+    edm::EDGetTokenT<GenEventInfoProduct> srcToken_;  // Generator/handronizer module label
+    edm::EDGetTokenT<GenEventInfoProduct> genEventInfoToken_;
+    edm::EDGetTokenT<std::vector<PileupSummaryInfo> > pileupInfoToken_;
+    edm::EDGetTokenT<std::vector<pat::Muon> > muonCollectionToken_;
+    edm::EDGetTokenT<reco::GenParticleCollection> prunedGenParticleCollectionToken_;
+    edm::EDGetTokenT<edm::TriggerResults> triggerTableToken_;
+
+    edm::EDGetTokenT<PatJetCollection> JetCollectionToken_;
+    edm::EDGetTokenT<PatJetCollection> FatJetCollectionToken_;
+    edm::EDGetTokenT<PatJetCollection> GroomedFatJetCollectionToken_;
+
+    edm::EDGetTokenT<reco::VertexCollection> primaryVertexCollToken_;
 
     std::string trackCHEBJetTags_;
     std::string trackCNegHEBJetTags_;
@@ -195,26 +761,10 @@ class BTagAnalyzerLiteT : public edm::EDAnalyzer
     std::string trackCHPBJetTags_;
     std::string trackCNegHPBJetTags_;
 
-    std::string simpleSVHighEffBJetTags_;
-    std::string simpleSVNegHighEffBJetTags_;
-    std::string simpleSVHighPurBJetTags_;
-    std::string simpleSVNegHighPurBJetTags_;
-
-    std::string combinedSVBJetTags_;
-    std::string combinedSVPosBJetTags_;
-    std::string combinedSVNegBJetTags_;
-
-    std::string combinedIVFSVBJetTags_;
-    std::string combinedIVFSVPosBJetTags_;
-    std::string combinedIVFSVNegBJetTags_;
+    // discriminators stored for each jet
+    std::vector<BTagAnalyzerLiteDiscriminator> discriminators_;
 
-    std::string softPFMuonBJetTags_;
-    std::string softPFMuonNegBJetTags_;
-    std::string softPFMuonPosBJetTags_;
 
-    std::string softPFElectronBJetTags_;
-    std::string softPFElectronNegBJetTags_;
-    std::string softPFElectronPosBJetTags_;
 
     std::string ipTagInfos_;
     std::string svTagInfos_;
@@ -228,49 +778,71 @@ class BTagAnalyzerLiteT : public edm::EDAnalyzer
     double minJetPt_;
     double maxJetEta_;
 
-    bool isData_;
-
     // trigger list
     std::vector<std::string> triggerPathNames_;
+    std::vector<boost::regex> triggerPathRegexes_;
 
     edm::Service<TFileService> fs;
 
     ///////////////
     // Ntuple info
 
+    // the tree is shared by all streams: the branches are registered with the buffers of the first
+    // stream and re-bound to the buffers being filled under outputFileMutex()
     TTree *smalltree;
 
-    //// Event info
-    EventInfoBranches EventInfo;
-
-    //// Jet info
-    JetInfoBranches JetInfo[MAX_JETCOLLECTIONS] ;
-
-    edm::Handle<reco::VertexCollection> primaryVertex;
-
-    const reco::Vertex *pv;
-    const GenericMVAJetTagComputer *computer;
+    // with splitTrees the jet, track, SV and tag variable columns go to linked trees (one entry per event,
+    // with Run and Evt for the index) and smalltree only keeps the event information
+    BranchTrees outputTrees_;
+    std::vector<TTree*> linkedTrees_;
+
+    // one entry per jet of the first jet collection (only with flatJetTree.enabled, created when the branches are registered)
+    TTree *flattree;
+    std::vector<std::string> flatJetKeys_;
+    std::vector<FlatJetTree::Block> flatJetBlocks_;
+    BTagAnalyzerLiteBranchSelection flatJetSelection_;
+    mutable std::unique_ptr<FlatJetTree> flatJetTree_;
+
+    // compression and basket size per group of branches, autoflush and autosave of all trees (ioSettings)
+    Long64_t autoFlush_;
+    Long64_t autoSave_;
+    mutable std::vector<BTagAnalyzerLiteIOGroup> ioGroups_;
+    mutable std::vector<std::pair<TBranch*,size_t> > ioBranches_;
+    mutable std::once_flag branchesRegistered_;
+    mutable const Buffers *boundBuffers_;
+
+    // computations needed by the stored branches of each jet collection (set when the branches are registered)
+    mutable BTagAnalyzerLiteJetDemand jetDemand_[MAX_JETCOLLECTIONS];
+
+    // mantissa bits stored for each branch (from branchPrecision, set when the branches are registered)
+    mutable std::vector<int> eventMantissaBits_;
+    mutable std::vector<int> jetMantissaBits_[MAX_JETCOLLECTIONS];
+    mutable bool truncateBranches_;
+
+    // largest value of each column counter over the filled entries (reported in endJob)
+    mutable std::vector<int> eventHighWaterMarks_;
+    mutable std::vector<int> jetHighWaterMarks_[MAX_JETCOLLECTIONS];
+
+    // background thread filling the tree (only with asyncTreeFilling)
+    std::unique_ptr<AsyncTreeWriter<Buffers> > treeWriter_;
+
+    // output branches of each entry of the event and jet schemas and the Run/Evt key branches added for splitTrees
+    // (kept when the branches are registered, to bind the buffers of the other streams)
+    mutable std::vector<TBranch*> eventBranches_;
+    mutable std::vector<TBranch*> jetBranches_[MAX_JETCOLLECTIONS];
+    mutable std::vector<std::pair<TBranch*,TBranch*> > keyBranches_;
 
     // Generator/hadronizer type (information stored bitwise)
-    unsigned int hadronizerType_;
-
-    // PF jet ID
-    PFJetIDSelectionFunctor pfjetIDLoose_;
-    PFJetIDSelectionFunctor pfjetIDTight_;
-
-    // N-subjettiness calculator
-    fastjet::contrib::Njettiness njettiness_;
+    mutable std::atomic<unsigned int> hadronizerType_;
 };
 
 
 template<typename IPTI,typename VTX>
 BTagAnalyzerLiteT<IPTI,VTX>::BTagAnalyzerLiteT(const edm::ParameterSet& iConfig):
-  pv(0),
-  computer(0),
-  hadronizerType_(0),
-  pfjetIDLoose_( PFJetIDSelectionFunctor::FIRSTDATA, PFJetIDSelectionFunctor::LOOSE ),
-  pfjetIDTight_( PFJetIDSelectionFunctor::FIRSTDATA, PFJetIDSelectionFunctor::TIGHT ),
-  njettiness_(fastjet::contrib::OnePass_KT_Axes(), fastjet::contrib::NormalizedMeasure(1.0,0.8))
+  flattree(0),
+  boundBuffers_(0),
+  truncateBranches_(false),
+  hadronizerType_(0)
 {
   //now do what ever initialization you need
   std::string module_type  = iConfig.getParameter<std::string>("@module_type");
@@ -286,20 +858,41 @@ BTagAnalyzerLiteT<IPTI,VTX>::BTagAnalyzerLiteT(const edm::ParameterSet& iConfig)
   storeMuonInfo_ = iConfig.getParameter<bool>("storeMuonInfo");
   storeTagVariables_ = iConfig.getParameter<bool>("storeTagVariables");
   storeCSVTagVariables_ = iConfig.getParameter<bool>("storeCSVTagVariables");
+  setupTagVarExtractors();
+  parallelJetProcessing_ = iConfig.getParameter<bool>("parallelJetProcessing");
+  asyncTreeFilling_ = iConfig.getParameter<bool>("asyncTreeFilling");
+  splitTrees_ = iConfig.getParameter<bool>("splitTrees");
+  branchSelection_ = BTagAnalyzerLiteBranchSelection::parse(iConfig.getParameter<std::vector<std::string> >("branchSelection"), "branchSelection");
+  const std::vector<std::string> branchPrecision = iConfig.getParameter<std::vector<std::string> >("branchPrecision");
+  for(std::vector<std::string>::const_iterator it = branchPrecision.begin(); it != branchPrecision.end(); ++it)
+  {
+    std::istringstream command(*it);
+    std::string pattern, rest;
+    int mantissaBits = -1;
+    command >> pattern >> mantissaBits;
+    if( command.fail() || mantissaBits < 0 || mantissaBits > 23 || ( command >> rest ) )
+      throw cms::Exception("Configuration") << "Invalid branchPrecision entry '" << *it << "', expected '<pattern> <mantissa bits (0-23)>'";
+    branchPrecision_.patterns.push_back( std::make_pair( mantissaBits, boost::regex(edm::glob2reg(pattern)) ) );
+  }
   minJetPt_  = iConfig.getParameter<double>("MinPt");
   maxJetEta_ = iConfig.getParameter<double>("MaxEta");
 
   // Modules
-  src_                 = iConfig.getParameter<edm::InputTag>("src");
-  muonCollectionName_       = iConfig.getParameter<edm::InputTag>("muonCollectionName");
-  prunedGenParticleCollectionName_ = iConfig.getParameter<edm::InputTag>("prunedGenParticles");
-  triggerTable_             = iConfig.getParameter<edm::InputTag>("triggerTable");
-
-  JetCollectionTag_ = iConfig.getParameter<edm::InputTag>("Jets");
-  FatJetCollectionTag_ = iConfig.getParameter<edm::InputTag>("FatJets");
-  GroomedFatJetCollectionTag_ = iConfig.getParameter<edm::InputTag>("GroomedFatJets");
+  srcToken_                 = consumes<GenEventInfoProduct>(iConfig.getParameter<edm::InputTag>("src"));
+  genEventInfoToken_        = consumes<GenEventInfoProduct>(iConfig.getParameter<edm::InputTag>("genEventInfo"));
+  pileupInfoToken_          = consumes<std::vector<PileupSummaryInfo> >(iConfig.getParameter<edm::InputTag>("pileupInfo"));
+  muonCollectionToken_      = consumes<std::vector<pat::Muon> >(iConfig.getParameter<edm::InputTag>("muonCollectionName"));
+  prunedGenParticleCollectionToken_ = consumes<reco::GenParticleCollection>(iConfig.getParameter<edm::InputTag>("prunedGenParticles"));
+  triggerTableToken_        = consumes<edm::TriggerResults>(iConfig.getParameter<edm::InputTag>("triggerTable"));
+
+  JetCollectionToken_ = consumes<PatJetCollection>(iConfig.getParameter<edm::InputTag>("Jets"));
+  if ( runSubJets_ )
+  {
+    FatJetCollectionToken_ = consumes<PatJetCollection>(iConfig.getParameter<edm::InputTag>("FatJets"));
+    GroomedFatJetCollectionToken_ = consumes<PatJetCollection>(iConfig.getParameter<edm::InputTag>("GroomedFatJets"));
+  }
 
-  primaryVertexColl_   = iConfig.getParameter<edm::InputTag>("primaryVertexColl");
+  primaryVertexCollToken_   = consumes<reco::VertexCollection>(iConfig.getParameter<edm::InputTag>("primaryVertexColl"));
 
   trackCHEBJetTags_    = iConfig.getParameter<std::string>("trackCHEBJetTags");
   trackCNegHEBJetTags_ = iConfig.getParameter<std::string>("trackCNegHEBJetTags");
@@ -307,34 +900,14 @@ BTagAnalyzerLiteT<IPTI,VTX>::BTagAnalyzerLiteT(const edm::ParameterSet& iConfig)
   trackCHPBJetTags_    = iConfig.getParameter<std::string>("trackCHPBJetTags");
   trackCNegHPBJetTags_ = iConfig.getParameter<std::string>("trackCNegHPBJetTags");
 
-  jetPBJetTags_        = iConfig.getParameter<std::string>("jetPBJetTags");
-  jetPNegBJetTags_     = iConfig.getParameter<std::string>("jetPNegBJetTags");
-  jetPPosBJetTags_     = iConfig.getParameter<std::string>("jetPPosBJetTags");
-
-  jetBPBJetTags_        = iConfig.getParameter<std::string>("jetBPBJetTags");
-  jetBPNegBJetTags_     = iConfig.getParameter<std::string>("jetBPNegBJetTags");
-  jetBPPosBJetTags_     = iConfig.getParameter<std::string>("jetBPPosBJetTags");
-
-  simpleSVHighEffBJetTags_      = iConfig.getParameter<std::string>("simpleSVHighEffBJetTags");
-  simpleSVNegHighEffBJetTags_   = iConfig.getParameter<std::string>("simpleSVNegHighEffBJetTags");
-  simpleSVHighPurBJetTags_      = iConfig.getParameter<std::string>("simpleSVHighPurBJetTags");
-  simpleSVNegHighPurBJetTags_   = iConfig.getParameter<std::string>("simpleSVNegHighPurBJetTags");
-
-  combinedSVBJetTags_     = iConfig.getParameter<std::string>("combinedSVBJetTags");
-  combinedSVPosBJetTags_  = iConfig.getParameter<std::string>("combinedSVPosBJetTags");
-  combinedSVNegBJetTags_  = iConfig.getParameter<std::string>("combinedSVNegBJetTags");
-
-  combinedIVFSVBJetTags_      = iConfig.getParameter<std::string>("combinedIVFSVBJetTags");
-  combinedIVFSVPosBJetTags_   = iConfig.getParameter<std::string>("combinedIVFSVPosBJetTags");
-  combinedIVFSVNegBJetTags_   = iConfig.getParameter<std::string>("combinedIVFSVNegBJetTags");
-
-  softPFMuonBJetTags_       = iConfig.getParameter<std::string>("softPFMuonBJetTags");
-  softPFMuonNegBJetTags_    = iConfig.getParameter<std::string>("softPFMuonNegBJetTags");
-  softPFMuonPosBJetTags_    = iConfig.getParameter<std::string>("softPFMuonPosBJetTags");
-
-  softPFElectronBJetTags_       = iConfig.getParameter<std::string>("softPFElectronBJetTags");
-  softPFElectronNegBJetTags_    = iConfig.getParameter<std::string>("softPFElectronNegBJetTags");
-  softPFElectronPosBJetTags_    = iConfig.getParameter<std::string>("softPFElectronPosBJetTags");
+  const std::vector<edm::ParameterSet> discriminators = iConfig.getParameter<std::vector<edm::ParameterSet> >("discriminators");
+  for(std::vector<edm::ParameterSet>::const_iterator it = discriminators.begin(); it != discriminators.end(); ++it)
+  {
+    BTagAnalyzerLiteDiscriminator discriminator;
+    discriminator.label  = it->getParameter<std::string>("label");
+    discriminator.branch = it->getParameter<std::string>("branch");
+    discriminators_.push_back(discriminator);
+  }
 
   ipTagInfos_              = iConfig.getParameter<std::string>("ipTagInfos");
   svTagInfos_              = iConfig.getParameter<std::string>("svTagInfos");
@@ -345,80 +918,445 @@ BTagAnalyzerLiteT<IPTI,VTX>::BTagAnalyzerLiteT(const edm::ParameterSet& iConfig)
   SVComputerFatJets_        = iConfig.getParameter<std::string>("svComputerFatJets");
 
   triggerPathNames_        = iConfig.getParameter<std::vector<std::string> >("TriggerPathNames");
+  for(std::vector<std::string>::const_iterator it = triggerPathNames_.begin(); it != triggerPathNames_.end(); ++it)
+    triggerPathRegexes_.push_back( boost::regex(edm::glob2reg(*it)) );
 
   ///////////////
   // TTree
 
-  smalltree = fs->make<TTree>("ttree", "ttree");
+  // RNTuple (nested jet -> track/SV/PF lepton collections instead of the Jet_nFirst*/Jet_nLast* ranges)
+  // needs ROOT 6.26 or later, which this release does not provide
+  const std::string outputFormat = iConfig.getParameter<std::string>("outputFormat");
+  if ( outputFormat == "RNTuple" )
+    throw cms::Exception("Configuration") << "outputFormat 'RNTuple' requires ROOT 6.26 or later, this release provides ROOT "
+                                          << ROOT_RELEASE << ". Please use outputFormat 'TTree'";
+  else if ( outputFormat != "TTree" )
+    throw cms::Exception("Configuration") << "Unknown outputFormat '" << outputFormat << "', expected 'TTree' or 'RNTuple'";
+
+  const edm::ParameterSet & ioSettings = iConfig.getParameter<edm::ParameterSet>("ioSettings");
+  autoFlush_ = ioSettings.getParameter<long long>("autoFlush");
+  autoSave_  = ioSettings.getParameter<long long>("autoSave");
+
+  std::vector<edm::ParameterSet> ioGroups = ioSettings.getParameter<std::vector<edm::ParameterSet> >("groups");
+  ioGroups.insert(ioGroups.begin(), ioSettings);
+  for(std::vector<edm::ParameterSet>::const_iterator it = ioGroups.begin(); it != ioGroups.end(); ++it)
+  {
+    BTagAnalyzerLiteIOGroup group;
+    group.name = ( it == ioGroups.begin() ? "default" : it->getParameter<std::string>("name") );
+    if( it != ioGroups.begin() )
+    {
+      const std::vector<std::string> branches = it->getParameter<std::vector<std::string> >("branches");
+      for(std::vector<std::string>::const_iterator branch = branches.begin(); branch != branches.end(); ++branch)
+        group.branches.push_back( boost::regex(edm::glob2reg(*branch)) );
+    }
+
+    const std::string algorithm = it->getParameter<std::string>("compressionAlgorithm");
+    const int level = it->getParameter<int>("compressionLevel");
+    ROOT::ECompressionAlgorithm code = ROOT::kZLIB;
+    if ( algorithm == "ZLIB" ) code = ROOT::kZLIB;
+    else if ( algorithm == "LZMA" ) code = ROOT::kLZMA;
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0)
+    else if ( algorithm == "LZ4" ) code = ROOT::kLZ4;
+#endif
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,20,0)
+    else if ( algorithm == "ZSTD" ) code = ROOT::kZSTD;
+#endif
+    else if ( algorithm != "" )
+      throw cms::Exception("Configuration") << "Compression algorithm '" << algorithm << "' of I/O group '" << group.name
+                                            << "' is not supported by ROOT " << ROOT_RELEASE;
+    if ( level > 9 )
+      throw cms::Exception("Configuration") << "Compression level " << level << " of I/O group '" << group.name << "' is out of range (0-9)";
+
+    group.compressionSettings = ( algorithm != "" && level >= 0 ? ROOT::CompressionSettings(code, level) : -1 );
+    group.basketSize = it->getParameter<int>("basketSize");
+    group.totBytes = group.zipBytes = 0;
+    ioGroups_.push_back(group);
+  }
+
+  smalltree = makeTree("ttree");
+  outputTrees_ = BranchTrees(smalltree);
+
+  if ( splitTrees_ )
+  {
+    const edm::ParameterSet & autoFlush = iConfig.getParameter<edm::ParameterSet>("splitTreesAutoFlush");
+    smalltree->SetAutoFlush( autoFlush.getParameter<long long>("ttree") );
+
+    // linked trees and the counters of the columns they hold
+    struct { const char * name; const char * counters[4]; } const linkedTrees[] = {
+      { "jettree",    { "nJet", "nSubJet", "nPFElectron", "nPFMuon" } },
+      { "tracktree",  { "nTrack", 0, 0, 0 } },
+      { "svtree",     { "nSV", 0, 0, 0 } },
+      { "tagvartree", { "nTrkTagVar", "nSVTagVar", "nTrkTagVarCSV", "nTrkEtaRelTagVarCSV" } }
+    };
+    for(size_t i=0; i<sizeof(linkedTrees)/sizeof(linkedTrees[0]); ++i)
+    {
+      TTree * tree = makeTree(linkedTrees[i].name);
+      tree->SetAutoFlush( autoFlush.getParameter<long long>(linkedTrees[i].name) );
+      for(size_t j=0; j<4 && linkedTrees[i].counters[j]; ++j) outputTrees_.Add(linkedTrees[i].counters[j], tree);
+      linkedTrees_.push_back(tree);
+    }
+  }
+
+  if ( asyncTreeFilling_ )
+    treeWriter_.reset( new AsyncTreeWriter<Buffers>( [this](Buffers & buffers) { fillTree(buffers); }, [this]() { return makeBuffers(); },
+                                                     iConfig.getParameter<unsigned int>("asyncTreeFillingQueueDepth") ) );
+
+  const edm::ParameterSet & flatJetTree = iConfig.getParameter<edm::ParameterSet>("flatJetTree");
+  if ( flatJetTree.getParameter<bool>("enabled") )
+  {
+    flattree = makeTree("flatjettree");
+    flatJetKeys_ = flatJetTree.getParameter<std::vector<std::string> >("keys");
+    flatJetSelection_ = BTagAnalyzerLiteBranchSelection::parse(flatJetTree.getParameter<std::vector<std::string> >("branchSelection"), "flatJetTree.branchSelection");
+
+    const std::vector<edm::ParameterSet> blocks = flatJetTree.getParameter<std::vector<edm::ParameterSet> >("blocks");
+    for(std::vector<edm::ParameterSet>::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+    {
+      FlatJetTree::Block block;
+      block.counter = it->getParameter<std::string>("counter");
+      block.first   = it->getParameter<std::string>("first");
+      block.last    = it->getParameter<std::string>("last");
+      block.sortKey = it->getParameter<std::string>("sortKey");
+      block.length  = it->getParameter<unsigned int>("length");
+      flatJetBlocks_.push_back(block);
+    }
+  }
+
+  std::cout << module_type << ":" << module_label << " constructed" << std::endl;
+}
+
+template<typename IPTI,typename VTX>
+BTagAnalyzerLiteT<IPTI,VTX>::~BTagAnalyzerLiteT()
+{
+}
+
+
+//
+// member functions
+//
+
+// ------------ method that allocates one set of ntuple buffers (with the configured discriminator branches)  ------------
+template<typename IPTI,typename VTX>
+typename BTagAnalyzerLiteT<IPTI,VTX>::Buffers * BTagAnalyzerLiteT<IPTI,VTX>::makeBuffers() const
+{
+  try {
+    return new Buffers(discriminators_);
+  }
+  catch (std::invalid_argument & e) {
+    throw cms::Exception("Configuration") << "Invalid discriminators: " << e.what();
+  }
+}
+
+// ------------ method called once for each stream to create its buffers  ------------
+template<typename IPTI,typename VTX>
+std::unique_ptr<typename BTagAnalyzerLiteT<IPTI,VTX>::StreamCache> BTagAnalyzerLiteT<IPTI,VTX>::beginStream(edm::StreamID) const
+{
+  std::unique_ptr<StreamCache> cache(new StreamCache(makeBuffers()));
+
+  // the branches are created with the buffers of whichever stream comes first
+  std::call_once(branchesRegistered_, [this,&cache]() {
+    std::lock_guard<std::mutex> lock(outputFileMutex());
+    registerBranches(*cache->buffers);
+    boundBuffers_ = cache->buffers.get();
+  });
+
+  return cache;
+}
+
+// ------------ method that creates the branches of the output tree  ------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::registerBranches(Buffers& buffers) const
+{
+  EventInfoBranches & EventInfo = buffers.EventInfo;
+  JetInfoBranches * JetInfo = buffers.JetInfo;
+
+  EventInfo.Select(branchSelection_);
+  JetInfo[0].Select(branchSelection_,(runSubJets_ ? "JetInfo" : ""));
+  JetInfo[1].Select(branchSelection_,"FatJetInfo");
 
   //--------------------------------------
   // event information
   //--------------------------------------
   if( storeEventInfo_ )
   {
-    EventInfo.RegisterTree(smalltree);
-    if ( produceJetTrackTree_ ) EventInfo.RegisterJetTrackTree(smalltree);
+    EventInfo.RegisterTree(outputTrees_);
+    if ( produceJetTrackTree_ ) EventInfo.RegisterJetTrackTree(outputTrees_);
   }
-  if ( storeMuonInfo_ ) EventInfo.RegisterMuonTree(smalltree);
+  if ( storeMuonInfo_ ) EventInfo.RegisterMuonTree(outputTrees_);
 
   //--------------------------------------
   // jet information
   //--------------------------------------
-  JetInfo[0].RegisterTree(smalltree,(runSubJets_ ? "JetInfo" : ""));
-  if ( runSubJets_ )          JetInfo[0].RegisterSubJetSpecificTree(smalltree,(runSubJets_ ? "JetInfo" : ""));
-  if ( produceJetTrackTree_ ) JetInfo[0].RegisterJetTrackTree(smalltree,(runSubJets_ ? "JetInfo" : ""));
-  if ( produceJetPFLeptonTree_ ) JetInfo[0].RegisterJetPFLeptonTree(smalltree,(runSubJets_ ? "JetInfo" : ""));
-  if ( storeTagVariables_)    JetInfo[0].RegisterTagVarTree(smalltree,(runSubJets_ ? "JetInfo" : ""));
-  if ( storeCSVTagVariables_) JetInfo[0].RegisterCSVTagVarTree(smalltree,(runSubJets_ ? "JetInfo" : ""));
+  JetInfo[0].RegisterTree(outputTrees_,(runSubJets_ ? "JetInfo" : ""));
+  if ( runSubJets_ )          JetInfo[0].RegisterSubJetSpecificTree(outputTrees_,(runSubJets_ ? "JetInfo" : ""));
+  if ( produceJetTrackTree_ ) JetInfo[0].RegisterJetTrackTree(outputTrees_,(runSubJets_ ? "JetInfo" : ""));
+  if ( produceJetPFLeptonTree_ ) JetInfo[0].RegisterJetPFLeptonTree(outputTrees_,(runSubJets_ ? "JetInfo" : ""));
+  if ( storeTagVariables_)    JetInfo[0].RegisterTagVarTree(outputTrees_,(runSubJets_ ? "JetInfo" : ""));
+  if ( storeCSVTagVariables_) JetInfo[0].RegisterCSVTagVarTree(outputTrees_,(runSubJets_ ? "JetInfo" : ""));
   if ( runSubJets_ ) {
-    JetInfo[1].RegisterTree(smalltree,"FatJetInfo");
-    JetInfo[1].RegisterFatJetSpecificTree(smalltree,"FatJetInfo");
-    if ( produceJetTrackTree_ ) JetInfo[1].RegisterJetTrackTree(smalltree,"FatJetInfo");
-    if ( produceJetPFLeptonTree_ ) JetInfo[1].RegisterJetPFLeptonTree(smalltree,"FatJetInfo");
-    if ( storeTagVariables_)    JetInfo[1].RegisterTagVarTree(smalltree,"FatJetInfo");
-    if ( storeCSVTagVariables_) JetInfo[1].RegisterCSVTagVarTree(smalltree,"FatJetInfo");
+    JetInfo[1].RegisterTree(outputTrees_,"FatJetInfo");
+    JetInfo[1].RegisterFatJetSpecificTree(outputTrees_,"FatJetInfo");
+    if ( produceJetTrackTree_ ) JetInfo[1].RegisterJetTrackTree(outputTrees_,"FatJetInfo");
+    if ( produceJetPFLeptonTree_ ) JetInfo[1].RegisterJetPFLeptonTree(outputTrees_,"FatJetInfo");
+    if ( storeTagVariables_)    JetInfo[1].RegisterTagVarTree(outputTrees_,"FatJetInfo");
+    if ( storeCSVTagVariables_) JetInfo[1].RegisterCSVTagVarTree(outputTrees_,"FatJetInfo");
   }
 
-  std::cout << module_type << ":" << module_label << " constructed" << std::endl;
+  // event keys of the linked trees, and of ttree when the event information is not stored (or Run/Evt are dropped):
+  // the trees are indexed and matched on them
+  if ( splitTrees_ )
+  {
+    if ( !smalltree->GetBranch("Run") || !smalltree->GetBranch("Evt") )
+      keyBranches_.push_back( std::make_pair( smalltree->Branch("Run", &EventInfo.Run, "Run/I"), smalltree->Branch("Evt", &EventInfo.Evt, "Evt/I") ) );
+
+    for(std::vector<TTree*>::const_iterator it = linkedTrees_.begin(); it != linkedTrees_.end(); ++it)
+    {
+      keyBranches_.push_back( std::make_pair( (*it)->Branch("Run", &EventInfo.Run, "Run/I"), (*it)->Branch("Evt", &EventInfo.Evt, "Evt/I") ) );
+    }
+  }
+
+  // the other sets of buffers are bound to the branches created here
+  eventBranches_ = EventInfo.Registry().Branches();
+  for(UInt_t iJetColl=0; iJetColl<MAX_JETCOLLECTIONS; ++iJetColl) jetBranches_[iJetColl] = JetInfo[iJetColl].Registry().Branches();
+
+  // per-jet tree
+  if ( flattree )
+  {
+    try {
+      flatJetTree_.reset( new FlatJetTree(flattree, EventInfo.Registry(), JetInfo[0].Registry(), flatJetKeys_, flatJetBlocks_, flatJetSelection_,
+                                          [this](int group) { return jetGroupFilled(0, JetInfoBranches::Group(group)); }) );
+    }
+    catch (std::invalid_argument & e) {
+      throw cms::Exception("Configuration") << "Invalid flatJetTree settings: " << e.what();
+    }
+  }
+
+  //--------------------------------------
+  // computations needed by the stored branches
+  //--------------------------------------
+  size_t nStored = 0, nBranches = 0;
+  for(UInt_t iJetColl=0; iJetColl<MAX_JETCOLLECTIONS; ++iJetColl)
+  {
+    const JetInfoBranches & jetInfo = JetInfo[iJetColl];
+    BTagAnalyzerLiteJetDemand & demand = jetDemand_[iJetColl];
+
+    // a branch is needed if it is stored or read from the buffers by the per-jet tree
+    const std::vector<BranchEntry> & entries = jetInfo.Registry().Entries();
+    std::vector<bool> needed(entries.size(), false);
+    for(size_t i=0; i<entries.size(); ++i) needed[i] = ( entries[i].branch != 0 );
+    if ( iJetColl == 0 && flatJetTree_ )
+    {
+      const std::vector<size_t> flatJetEntries = flatJetTree_->JetEntries();
+      for(std::vector<size_t>::const_iterator it = flatJetEntries.begin(); it != flatJetEntries.end(); ++it) needed[*it] = true;
+    }
+    auto isNeeded = [&](const std::string & name) {
+      const BranchEntry * entry = jetInfo.Registry().Find(name);
+      return ( entry && needed[entry - &entries[0]] );
+    };
+
+    demand.tracksPV          = ( isNeeded("Track_PV") || isNeeded("Track_PVweight") || isNeeded("SV_EnergyRatio") );
+    demand.tracksSV          = ( isNeeded("Track_isfromSV") || isNeeded("Track_SV") || isNeeded("Track_SVweight") );
+    demand.svJetAxisDistance = isNeeded("SV_vtxDistJetAxis");
+    demand.nsubjettinessIVF  = ( isNeeded("Jet_tau1IVF") || isNeeded("Jet_tau2IVF") );
+
+    demand.csvTagVariables = false;
+    for(size_t i=0; i<entries.size(); ++i)
+      if( needed[i] && entries[i].name.find("TagVarCSV") != std::string::npos ) demand.csvTagVariables = true;
+
+    demand.discriminators.clear();
+    for(size_t i=0; i<discriminators_.size(); ++i)
+      if( isNeeded(discriminators_[i].branch) ) demand.discriminators.push_back(i);
+  }
+
+  const BranchRegistry * registries[] = { &EventInfo.Registry(), &JetInfo[0].Registry(), &JetInfo[1].Registry() };
+  for(size_t i=0; i<sizeof(registries)/sizeof(registries[0]); ++i)
+    for(std::vector<BranchEntry>::const_iterator it = registries[i]->Entries().begin(); it != registries[i]->Entries().end(); ++it)
+    {
+      ++nBranches;
+      if( it->branch ) ++nStored;
+    }
+  edm::LogInfo("BranchSelection") << nStored << " of " << nBranches << " branches stored";
+
+  //--------------------------------------
+  // reduced precision
+  //--------------------------------------
+  eventMantissaBits_ = EventInfo.MantissaBits(branchPrecision_);
+  jetMantissaBits_[0] = JetInfo[0].MantissaBits(branchPrecision_,(runSubJets_ ? "JetInfo" : ""));
+  jetMantissaBits_[1] = JetInfo[1].MantissaBits(branchPrecision_,"FatJetInfo");
+
+  truncateBranches_ = ( std::count_if(eventMantissaBits_.begin(), eventMantissaBits_.end(), [](int bits) { return bits >= 0; }) > 0 );
+  for(UInt_t iJetColl=0; iJetColl<MAX_JETCOLLECTIONS; ++iJetColl)
+    truncateBranches_ |= ( std::count_if(jetMantissaBits_[iJetColl].begin(), jetMantissaBits_[iJetColl].end(), [](int bits) { return bits >= 0; }) > 0 );
+
+  configureIO();
 }
 
+// ------------ method that tells whether the branches of a group of a jet collection are filled (see registerBranches)  ------------
 template<typename IPTI,typename VTX>
-BTagAnalyzerLiteT<IPTI,VTX>::~BTagAnalyzerLiteT()
+bool BTagAnalyzerLiteT<IPTI,VTX>::jetGroupFilled(int iJetColl, JetInfoBranches::Group group) const
 {
+  if ( iJetColl == 1 && !runSubJets_ ) return false;
+
+  switch ( group )
+  {
+    case JetInfoBranches::Tree:               return true;
+    case JetInfoBranches::JetPFLeptonTree:    return produceJetPFLeptonTree_;
+    case JetInfoBranches::JetTrackTree:       return produceJetTrackTree_;
+    case JetInfoBranches::TagVarTree:         return storeTagVariables_;
+    case JetInfoBranches::CSVTagVarTree:      return storeCSVTagVariables_;
+    case JetInfoBranches::SubJetSpecificTree: return ( iJetColl == 0 && runSubJets_ );
+    case JetInfoBranches::FatJetSpecificTree: return ( iJetColl == 1 );
+  }
+  return false;
 }
 
+// ------------ method that creates an output tree with the configured autoflush and autosave  ------------
+template<typename IPTI,typename VTX>
+TTree * BTagAnalyzerLiteT<IPTI,VTX>::makeTree(const char * name)
+{
+  TTree * tree = fs->make<TTree>(name, name);
+  tree->SetAutoFlush(autoFlush_);
+  tree->SetAutoSave(autoSave_);
+  return tree;
+}
 
-//
-// member functions
-//
+// ------------ method that applies the compression and basket size of the I/O groups to the output branches  ------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::configureIO() const
+{
+  std::vector<TTree*> trees(1, smalltree);
+  trees.insert(trees.end(), linkedTrees_.begin(), linkedTrees_.end());
+  if ( flattree ) trees.push_back(flattree);
+
+  for(std::vector<TTree*>::const_iterator tree = trees.begin(); tree != trees.end(); ++tree)
+  {
+    TIter next((*tree)->GetListOfBranches());
+    while ( TBranch * branch = static_cast<TBranch*>(next()) )
+    {
+      // the last group matching the branch name, the default group otherwise
+      size_t iGroup = 0;
+      for(size_t i=1; i<ioGroups_.size(); ++i)
+        for(std::vector<boost::regex>::const_iterator it = ioGroups_[i].branches.begin(); it != ioGroups_[i].branches.end(); ++it)
+          if ( boost::regex_match(std::string(branch->GetName()), *it) ) iGroup = i;
+
+      // settings the group leaves at the ROOT default are taken from the default group
+      const int compressionSettings = ( ioGroups_[iGroup].compressionSettings >= 0 ? ioGroups_[iGroup].compressionSettings : ioGroups_[0].compressionSettings );
+      const int basketSize = ( ioGroups_[iGroup].basketSize > 0 ? ioGroups_[iGroup].basketSize : ioGroups_[0].basketSize );
+      if ( compressionSettings >= 0 ) branch->SetCompressionSettings(compressionSettings);
+      if ( basketSize > 0 ) branch->SetBasketSize(basketSize);
+
+      ioBranches_.push_back( std::make_pair(branch, iGroup) );
+    }
+  }
+}
+
+// ------------ method that points the branches of the output tree to the buffers of a given stream  ------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::bindBranches(Buffers& buffers) const
+{
+  // through the branches kept when they were created, so that no branch is looked up by name
+  buffers.EventInfo.Registry().Bind(eventBranches_);
+  for(UInt_t iJetColl=0; iJetColl<MAX_JETCOLLECTIONS; ++iJetColl)
+    buffers.JetInfo[iJetColl].Registry().Bind(jetBranches_[iJetColl]);
+
+  for(std::vector<std::pair<TBranch*,TBranch*> >::const_iterator it = keyBranches_.begin(); it != keyBranches_.end(); ++it)
+  {
+    it->first->SetAddress(&buffers.EventInfo.Run);
+    it->second->SetAddress(&buffers.EventInfo.Evt);
+  }
+}
+
+// ------------ method that fills the output tree from the buffers of a given stream  ------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::fillTree(StreamCache& cache) const
+{
+  // with asyncTreeFilling the buffers are handed to the background writer and the stream continues with a free set
+  if ( treeWriter_ )
+    cache.buffers = treeWriter_->push( std::move(cache.buffers) );
+  else
+    fillTree(*cache.buffers);
+}
+
+// ------------ method that fills one entry of the output tree from a given set of buffers  ------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::fillTree(Buffers& buffers) const
+{
+  // only touches the buffers being written, so it is done before taking the lock
+  if( truncateBranches_ ) truncateBranches(buffers);
+
+  std::lock_guard<std::mutex> lock(outputFileMutex());
+
+  // the columns are (re)bound if they belong to another set or had to grow
+  if( buffers.Fit() || boundBuffers_ != &buffers )
+  {
+    bindBranches(buffers);
+    boundBuffers_ = &buffers;
+  }
+  updateHighWaterMarks(buffers);
+
+  smalltree->Fill();
+  for(std::vector<TTree*>::const_iterator it = linkedTrees_.begin(); it != linkedTrees_.end(); ++it)
+    (*it)->Fill();
+  if ( flatJetTree_ ) flatJetTree_->Fill(buffers.EventInfo.Registry(), buffers.JetInfo[0].Registry());
+}
+
+// ------------ method that reduces the precision of the float branches selected by branchPrecision  ------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::truncateBranches(Buffers& buffers) const
+{
+  buffers.EventInfo.Truncate(eventMantissaBits_);
+  for(UInt_t iJetColl=0; iJetColl<MAX_JETCOLLECTIONS; ++iJetColl)
+    buffers.JetInfo[iJetColl].Truncate(jetMantissaBits_[iJetColl]);
+}
+
+// ------------ method that keeps track of the largest number of entries in the variable-length columns  ------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::updateHighWaterMarks(const Buffers& buffers) const
+{
+  const std::vector<const int*> & counters = buffers.eventCounters;
+  eventHighWaterMarks_.resize(counters.size(), 0);
+  for(size_t i=0; i<counters.size(); ++i)
+    eventHighWaterMarks_[i] = std::max(eventHighWaterMarks_[i], *counters[i]);
+
+  for(UInt_t iJetColl=0; iJetColl<MAX_JETCOLLECTIONS; ++iJetColl)
+  {
+    const std::vector<const int*> & jetCounters = buffers.jetCounters[iJetColl];
+    jetHighWaterMarks_[iJetColl].resize(jetCounters.size(), 0);
+    for(size_t i=0; i<jetCounters.size(); ++i)
+      jetHighWaterMarks_[iJetColl][i] = std::max(jetHighWaterMarks_[iJetColl][i], *jetCounters[i]);
+  }
+}
 
 // ------------ method called to for each event  ------------
 template<typename IPTI,typename VTX>
-void BTagAnalyzerLiteT<IPTI,VTX>::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
+void BTagAnalyzerLiteT<IPTI,VTX>::analyze(edm::StreamID iStreamID, const edm::Event& iEvent, const edm::EventSetup& iSetup) const
 {
   using namespace edm;
   using namespace std;
   using namespace reco;
 
+  // per-stream buffers
+  StreamCache & cache = *streamCache(iStreamID);
+  EventInfoBranches & EventInfo = cache.buffers->EventInfo;
+
   //------------------------------------------------------
   // Event information
   //------------------------------------------------------
   EventInfo.Run = iEvent.id().run();
-  isData_ = iEvent.isRealData();
+  cache.isData = iEvent.isRealData();
 
-  if ( !isData_ && EventInfo.Run > 0 ) EventInfo.Run = -EventInfo.Run;
+  if ( !cache.isData && EventInfo.Run > 0 ) EventInfo.Run = -EventInfo.Run;
 
   EventInfo.Evt  = iEvent.id().event();
   EventInfo.LumiBlock  = iEvent.luminosityBlock();
 
   edm::Handle <PatJetCollection> jetsColl;
-  iEvent.getByLabel (JetCollectionTag_, jetsColl);
+  iEvent.getByToken(JetCollectionToken_, jetsColl);
 
   edm::Handle <PatJetCollection> fatjetsColl;
   edm::Handle <PatJetCollection> groomedfatjetsColl;
   if (runSubJets_) {
-    iEvent.getByLabel(FatJetCollectionTag_, fatjetsColl) ;
-    iEvent.getByLabel(GroomedFatJetCollectionTag_, groomedfatjetsColl) ;
+    iEvent.getByToken(FatJetCollectionToken_, fatjetsColl) ;
+    iEvent.getByToken(GroomedFatJetCollectionToken_, groomedfatjetsColl) ;
   }
 
   // match groomed and original fat jets
@@ -429,15 +1367,24 @@ void BTagAnalyzerLiteT<IPTI,VTX>::analyze(const edm::Event& iEvent, const edm::E
       edm::LogError("TooManyGroomedJets") << "There are more groomed (" << groomedfatjetsColl->size() << ") than original fat jets (" << fatjetsColl->size() << "). Please check that the two jet collections belong to each other.";
 
     matchGroomedJets(fatjetsColl,groomedfatjetsColl,groomedIndices);
+    cache.subJetTable.fill(*jetsColl,*groomedfatjetsColl,groomedIndices);
+  }
+
+  // JEC factors read for Jet_jes, Jet_residual, Jet_jesGroomed and the subjet ordering
+  cache.jecFactors[0].fill(*jetsColl, BTagAnalyzerLiteJECFactors::L3Absolute);
+  if (runSubJets_)
+  {
+    cache.jecFactors[1].fill(*fatjetsColl, BTagAnalyzerLiteJECFactors::L3Absolute);
+    cache.jecFactors[2].fill(*groomedfatjetsColl, BTagAnalyzerLiteJECFactors::Uncorrected);
   }
 
   //------------------------------------------------------
   // Determine hadronizer type (done only once per job)
   //------------------------------------------------------
-  if( !isData_ && hadronizerType_ == 0 )
+  if( !cache.isData && hadronizerType_ == 0 )
   {
     edm::Handle<GenEventInfoProduct> genEvtInfoProduct;
-    iEvent.getByLabel(src_, genEvtInfoProduct);
+    iEvent.getByToken(srcToken_, genEvtInfoProduct);
 
     std::string moduleName = "";
     if( genEvtInfoProduct.isValid() )
@@ -463,130 +1410,208 @@ void BTagAnalyzerLiteT<IPTI,VTX>::analyze(const edm::Event& iEvent, const edm::E
   EventInfo.mcweight   = 1.;
 
   //---------------------------- Start MC info ---------------------------------------//
-  if ( !isData_ && storeEventInfo_ ) {
-    // pthat
-    edm::Handle<GenEventInfoProduct> geninfos;
-    iEvent.getByLabel( "generator",geninfos );
-    EventInfo.mcweight=geninfos->weight();
-    if (geninfos->binningValues().size()>0) EventInfo.pthat = geninfos->binningValues()[0];
-
-    // pileup
-    edm::Handle<std::vector <PileupSummaryInfo> > PupInfo;
-    iEvent.getByLabel("addPileupInfo", PupInfo);
-
-    std::vector<PileupSummaryInfo>::const_iterator ipu;
-    for (ipu = PupInfo->begin(); ipu != PupInfo->end(); ++ipu) {
-      if ( ipu->getBunchCrossing() != 0 ) continue; // storing detailed PU info only for BX=0
-      for (unsigned int i=0; i<ipu->getPU_zpositions().size(); ++i) {
-        EventInfo.PU_bunch[EventInfo.nPU]      =  ipu->getBunchCrossing();
-        EventInfo.PU_z[EventInfo.nPU]          = (ipu->getPU_zpositions())[i];
-        EventInfo.PU_sumpT_low[EventInfo.nPU]  = (ipu->getPU_sumpT_lowpT())[i];
-        EventInfo.PU_sumpT_high[EventInfo.nPU] = (ipu->getPU_sumpT_highpT())[i];
-        EventInfo.PU_ntrks_low[EventInfo.nPU]  = (ipu->getPU_ntrks_lowpT())[i];
-        EventInfo.PU_ntrks_high[EventInfo.nPU] = (ipu->getPU_ntrks_highpT())[i];
-        ++EventInfo.nPU;
-      }
-      EventInfo.nPUtrue = ipu->getTrueNumInteractions();
-      if(EventInfo.nPU==0) EventInfo.nPU = ipu->getPU_NumInteractions(); // needed in case getPU_zpositions() is empty
-    }
+  edm::Handle<GenEventInfoProduct> geninfos;
+  edm::Handle<std::vector <PileupSummaryInfo> > PupInfo;
+  edm::Handle<reco::GenParticleCollection> prunedGenParticles;
+  if ( !cache.isData && storeEventInfo_ ) {
+    iEvent.getByToken(genEventInfoToken_, geninfos);
+    iEvent.getByToken(pileupInfoToken_, PupInfo);
+    iEvent.getByToken(prunedGenParticleCollectionToken_, prunedGenParticles);
+  }
+  //---------------------------- End MC info ---------------------------------------//
+  //   std::cout << "EventInfo.Evt:" <<EventInfo.Evt << std::endl;
+  //   std::cout << "EventInfo.pthat:" <<EventInfo.pthat << std::endl;
+
+  //------------------------------------------------------
+  // Muons
+  //------------------------------------------------------
+  edm::Handle<std::vector<pat::Muon> >  muonsHandle;
+  if( storeMuonInfo_ ) iEvent.getByToken(muonCollectionToken_, muonsHandle);
+
+  //------------------
+  // Primary vertex
+  //------------------
+  edm::Handle<reco::VertexCollection> & primaryVertex = cache.primaryVertex;
+  iEvent.getByToken(primaryVertexCollToken_, primaryVertex);
+
+  //------------------------------------------------------
+  // Trigger info
+  //------------------------------------------------------
+
+  edm::Handle<edm::TriggerResults> trigRes;
+  iEvent.getByToken(triggerTableToken_, trigRes);
+
+  EventInfo.nBitTrigger = int(triggerPathNames_.size()/32)+1;
+  for(int i=0; i<EventInfo.nBitTrigger; ++i) EventInfo.BitTrigger[i] = 0;
+
+  if ( trigRes->parameterSetID() != cache.triggerNamesID ) updateTriggerMasks(*trigRes, cache);
+
+  //------------- added by Camille-----------------------------------------------------------//
+  if ( cache.computerWatcher.check(iSetup) )
+  {
+    cache.jetComputer = getComputer(iSetup, SVComputer_);
+    cache.fatJetComputer = ( runSubJets_ ? ( SVComputerFatJets_!=SVComputer_ ? getComputer(iSetup, SVComputerFatJets_) : cache.jetComputer ) : 0 );
+  }
+  cache.computer = cache.jetComputer;
+  //------------- end added-----------------------------------------------------------//
+
+  //------------------------------------------------------
+  // Event processing
+  //------------------------------------------------------
+  // all products were retrieved above so the independent stages only read them: the MC, muon and
+  // trigger information are filled in concurrent tasks while this thread goes through the chain
+  // primary vertex -> subjets -> fat jets (the fat jets read the subjet kinematics)
+  tbb::task_group stages;
+
+  if ( !cache.isData && storeEventInfo_ )
+    stages.run( [&]() { processGen(geninfos, PupInfo, prunedGenParticles, EventInfo); } );
+  if ( storeMuonInfo_ )
+    stages.run( [&]() { processMuons(muonsHandle, EventInfo); } );
+  stages.run( [&]() { processTrig(trigRes, cache.triggerMasks, EventInfo); } );
+
+  try {
+    processPV(cache);
 
     //------------------------------------------------------
-    // pruned generated particles
+    // Jet info
+    //------------------------------------------------------
+    int iJetColl = 0 ;
+    //// Do jets
+    processJets(jetsColl, fatjetsColl, iEvent, iSetup, groomedfatjetsColl, groomedIndices, iJetColl, cache) ;
+    if (runSubJets_) {
+      iJetColl = 1 ;
+      // for fat jets we might have a different jet tag computer
+      cache.computer = cache.fatJetComputer;
+      processJets(fatjetsColl, jetsColl, iEvent, iSetup, groomedfatjetsColl, groomedIndices, iJetColl, cache) ;
+    }
     //------------------------------------------------------
-    edm::Handle<reco::GenParticleCollection> prunedGenParticles;
-    iEvent.getByLabel(prunedGenParticleCollectionName_, prunedGenParticles);
-
-    EventInfo.GenPVz = -1000.;
-
-    // loop over pruned GenParticles to fill branches for MC hard process particles and muons
-    for(size_t i = 0; i < prunedGenParticles->size(); ++i){
-      const GenParticle & iGenPart = (*prunedGenParticles)[i];
-      int status = iGenPart.status();
-      int pdgid = iGenPart.pdgId();
-      int numMothers = iGenPart.numberOfMothers();
-
-      if ( isHardProcess(iGenPart.status()) ) EventInfo.GenPVz = iGenPart.vz();
-
-      //fill all the branches
-      EventInfo.GenPruned_pT[EventInfo.nGenPruned] = iGenPart.pt();
-      EventInfo.GenPruned_eta[EventInfo.nGenPruned] = iGenPart.eta();
-      EventInfo.GenPruned_phi[EventInfo.nGenPruned] = iGenPart.phi();
-      EventInfo.GenPruned_mass[EventInfo.nGenPruned] = iGenPart.mass();
-      EventInfo.GenPruned_status[EventInfo.nGenPruned] = status;
-      EventInfo.GenPruned_pdgID[EventInfo.nGenPruned] = pdgid;
-      // if no mothers, set mother index to -1 (just so it's not >=0)
-      if (numMothers == 0)
-        EventInfo.GenPruned_mother[EventInfo.nGenPruned] = -1;
-      else{
-        //something new to distinguish from the no mothers case
-        int idx = -100;
-        //loop over the pruned genparticle list to get the mother's index
-        for( reco::GenParticleCollection::const_iterator mit = prunedGenParticles->begin(); mit != prunedGenParticles->end(); ++mit ) {
-          if( iGenPart.mother(0)==&(*mit) ) {
-            idx = std::distance(prunedGenParticles->begin(),mit);
-            break;
-          }
-        }
-        EventInfo.GenPruned_mother[EventInfo.nGenPruned] = idx;
-      }
-      ++EventInfo.nGenPruned;
-    } //end loop over pruned GenParticles
+  }
+  catch (...) {
+    // the stages still read the products and write the stream buffers so they have to finish first;
+    // an exception raised in a stage is dropped so that the one being handled is propagated
+    stages.cancel();
+    try { stages.wait(); }
+    catch (...) {}
+    throw;
   }
 
-  //---------------------------- End MC info ---------------------------------------//
-  //   std::cout << "EventInfo.Evt:" <<EventInfo.Evt << std::endl;
-  //   std::cout << "EventInfo.pthat:" <<EventInfo.pthat << std::endl;
+  // join the event-level stages (rethrows any exception raised in them)
+  stages.wait();
+
+  //// Fill TTree
+  // (every event is stored: the former 'EventInfo.BitTrigger > 0' test compared the address of the fixed-size array and always passed)
+  fillTree(cache);
+
+  return;
+}
+
+
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::processGen(const edm::Handle<GenEventInfoProduct>& geninfos, const edm::Handle<std::vector<PileupSummaryInfo> >& PupInfo,
+                                             const edm::Handle<reco::GenParticleCollection>& prunedGenParticles, EventInfoBranches& EventInfo) const
+{
+  using namespace reco;
+
+  // pthat
+  EventInfo.mcweight=geninfos->weight();
+  if (geninfos->binningValues().size()>0) EventInfo.pthat = geninfos->binningValues()[0];
+
+  // pileup
+  std::vector<PileupSummaryInfo>::const_iterator ipu;
+  for (ipu = PupInfo->begin(); ipu != PupInfo->end(); ++ipu) {
+    if ( ipu->getBunchCrossing() != 0 ) continue; // storing detailed PU info only for BX=0
+    for (unsigned int i=0; i<ipu->getPU_zpositions().size(); ++i) {
+      EventInfo.PU_bunch[EventInfo.nPU]      =  ipu->getBunchCrossing();
+      EventInfo.PU_z[EventInfo.nPU]          = (ipu->getPU_zpositions())[i];
+      EventInfo.PU_sumpT_low[EventInfo.nPU]  = (ipu->getPU_sumpT_lowpT())[i];
+      EventInfo.PU_sumpT_high[EventInfo.nPU] = (ipu->getPU_sumpT_highpT())[i];
+      EventInfo.PU_ntrks_low[EventInfo.nPU]  = (ipu->getPU_ntrks_lowpT())[i];
+      EventInfo.PU_ntrks_high[EventInfo.nPU] = (ipu->getPU_ntrks_highpT())[i];
+      ++EventInfo.nPU;
+    }
+    EventInfo.nPUtrue = ipu->getTrueNumInteractions();
+    if(EventInfo.nPU==0) EventInfo.nPU = ipu->getPU_NumInteractions(); // needed in case getPU_zpositions() is empty
+  }
 
   //------------------------------------------------------
-  // Muons
+  // pruned generated particles
   //------------------------------------------------------
-  edm::Handle<std::vector<pat::Muon> >  muonsHandle;
-  if( storeMuonInfo_ )
-  {
-    iEvent.getByLabel(muonCollectionName_,muonsHandle);
+  EventInfo.GenPVz = -1000.;
+
+  // index of a mother (or daughter) reference in the pruned GenParticles: the mothers and daughters of pruned particles
+  // point into the same collection so the index is the reference key (something new, -100, for references to another collection)
+  auto prunedIndex = [&prunedGenParticles](const reco::GenParticleRef & ref) { return ( ref.id() == prunedGenParticles.id() ? int(ref.key()) : -100 ); };
+
+  // loop over pruned GenParticles to fill branches for MC hard process particles and muons
+  for(size_t i = 0; i < prunedGenParticles->size(); ++i){
+    const GenParticle & iGenPart = (*prunedGenParticles)[i];
+    int status = iGenPart.status();
+    int pdgid = iGenPart.pdgId();
+    int numMothers = iGenPart.numberOfMothers();
+
+    if ( isHardProcess(iGenPart.status()) ) EventInfo.GenPVz = iGenPart.vz();
+
+    //fill all the branches
+    EventInfo.GenPruned_pT[EventInfo.nGenPruned] = iGenPart.pt();
+    EventInfo.GenPruned_eta[EventInfo.nGenPruned] = iGenPart.eta();
+    EventInfo.GenPruned_phi[EventInfo.nGenPruned] = iGenPart.phi();
+    EventInfo.GenPruned_mass[EventInfo.nGenPruned] = iGenPart.mass();
+    EventInfo.GenPruned_status[EventInfo.nGenPruned] = status;
+    EventInfo.GenPruned_pdgID[EventInfo.nGenPruned] = pdgid;
+    // if no mothers, set mother index to -1 (just so it's not >=0)
+    if (numMothers == 0)
+      EventInfo.GenPruned_mother[EventInfo.nGenPruned] = -1;
+    else
+      EventInfo.GenPruned_mother[EventInfo.nGenPruned] = prunedIndex(iGenPart.motherRef(0));
+    ++EventInfo.nGenPruned;
+  } //end loop over pruned GenParticles
 
-    for( std::vector<pat::Muon>::const_iterator it = muonsHandle->begin(); it != muonsHandle->end(); ++it )
-    {
-      if( !it->isGlobalMuon() ) continue;
-
-      EventInfo.Muon_isGlobal[EventInfo.nMuon] = 1;
-      EventInfo.Muon_isPF[EventInfo.nMuon]     = it->isPFMuon();
-      EventInfo.Muon_nTkHit[EventInfo.nMuon]   = it->innerTrack()->hitPattern().numberOfValidHits();
-      EventInfo.Muon_nPixHit[EventInfo.nMuon]  = it->innerTrack()->hitPattern().numberOfValidPixelHits();
-      EventInfo.Muon_nOutHit[EventInfo.nMuon]  = it->innerTrack()->hitPattern().numberOfHits(reco::HitPattern::MISSING_OUTER_HITS);
-      EventInfo.Muon_nMuHit[EventInfo.nMuon]   = it->outerTrack()->hitPattern().numberOfValidMuonHits();
-      EventInfo.Muon_nMatched[EventInfo.nMuon] = it->numberOfMatches();
-      EventInfo.Muon_chi2[EventInfo.nMuon]     = it->globalTrack()->normalizedChi2();
-      EventInfo.Muon_chi2Tk[EventInfo.nMuon]   = it->innerTrack()->normalizedChi2();
-      EventInfo.Muon_pt[EventInfo.nMuon]       = it->pt();
-      EventInfo.Muon_eta[EventInfo.nMuon]      = it->eta();
-      EventInfo.Muon_phi[EventInfo.nMuon]      = it->phi();
-      EventInfo.Muon_vz[EventInfo.nMuon]       = it->vz();
-      EventInfo.Muon_IP[EventInfo.nMuon]       = it->dB(pat::Muon::PV3D);
-      EventInfo.Muon_IPsig[EventInfo.nMuon]    = (it->dB(pat::Muon::PV3D))/(it->edB(pat::Muon::PV3D));
-      EventInfo.Muon_IP2D[EventInfo.nMuon]     = it->dB(pat::Muon::PV2D);
-      EventInfo.Muon_IP2Dsig[EventInfo.nMuon]  = (it->dB(pat::Muon::PV2D))/(it->edB(pat::Muon::PV2D));
-
-      ++EventInfo.nMuon;
-    }
+  return;
+}
+
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::processMuons(const edm::Handle<std::vector<pat::Muon> >& muonsHandle, EventInfoBranches& EventInfo) const
+{
+  for( std::vector<pat::Muon>::const_iterator it = muonsHandle->begin(); it != muonsHandle->end(); ++it )
+  {
+    if( !it->isGlobalMuon() ) continue;
+
+    EventInfo.Muon_isGlobal[EventInfo.nMuon] = 1;
+    EventInfo.Muon_isPF[EventInfo.nMuon]     = it->isPFMuon();
+    EventInfo.Muon_nTkHit[EventInfo.nMuon]   = it->innerTrack()->hitPattern().numberOfValidHits();
+    EventInfo.Muon_nPixHit[EventInfo.nMuon]  = it->innerTrack()->hitPattern().numberOfValidPixelHits();
+    EventInfo.Muon_nOutHit[EventInfo.nMuon]  = it->innerTrack()->hitPattern().numberOfHits(reco::HitPattern::MISSING_OUTER_HITS);
+    EventInfo.Muon_nMuHit[EventInfo.nMuon]   = it->outerTrack()->hitPattern().numberOfValidMuonHits();
+    EventInfo.Muon_nMatched[EventInfo.nMuon] = it->numberOfMatches();
+    EventInfo.Muon_chi2[EventInfo.nMuon]     = it->globalTrack()->normalizedChi2();
+    EventInfo.Muon_chi2Tk[EventInfo.nMuon]   = it->innerTrack()->normalizedChi2();
+    EventInfo.Muon_pt[EventInfo.nMuon]       = it->pt();
+    EventInfo.Muon_eta[EventInfo.nMuon]      = it->eta();
+    EventInfo.Muon_phi[EventInfo.nMuon]      = it->phi();
+    EventInfo.Muon_vz[EventInfo.nMuon]       = it->vz();
+    EventInfo.Muon_IP[EventInfo.nMuon]       = it->dB(pat::Muon::PV3D);
+    EventInfo.Muon_IPsig[EventInfo.nMuon]    = (it->dB(pat::Muon::PV3D))/(it->edB(pat::Muon::PV3D));
+    EventInfo.Muon_IP2D[EventInfo.nMuon]     = it->dB(pat::Muon::PV2D);
+    EventInfo.Muon_IP2Dsig[EventInfo.nMuon]  = (it->dB(pat::Muon::PV2D))/(it->edB(pat::Muon::PV2D));
+
+    ++EventInfo.nMuon;
   }
 
-  //------------------
-  // Primary vertex
-  //------------------
-  iEvent.getByLabel(primaryVertexColl_,primaryVertex);
+  return;
+}
+
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::processPV(StreamCache& cache) const
+{
+  EventInfoBranches & EventInfo = cache.buffers->EventInfo;
+  const edm::Handle<reco::VertexCollection> & primaryVertex = cache.primaryVertex;
 
   bool pvFound = (primaryVertex->size() != 0);
   if ( pvFound ) {
-    pv = &(*primaryVertex->begin());
+    cache.pv = &(*primaryVertex->begin());
   }
   else {
-    reco::Vertex::Error e;
-    e(0,0)=0.0015*0.0015;
-    e(1,1)=0.0015*0.0015;
-    e(2,2)=15.*15.;
-    reco::Vertex::Point p(0,0,0);
-    pv=  new reco::Vertex(p,e,1,1,1);
+    cache.pv = &cache.dummyPV;
   }
   //   GlobalPoint Pv_point = GlobalPoint((*pv).x(), (*pv).y(), (*pv).z());
   EventInfo.PVz = (*primaryVertex)[0].z();
@@ -608,773 +1633,764 @@ void BTagAnalyzerLiteT<IPTI,VTX>::analyze(const edm::Event& iEvent, const edm::E
     ++EventInfo.nPV;
   }
 
-  //------------------------------------------------------
-  // Trigger info
-  //------------------------------------------------------
+  if ( jetDemand_[0].tracksPV || jetDemand_[1].tracksPV ) cache.trackPVs.fill(*primaryVertex);
 
-  edm::Handle<edm::TriggerResults> trigRes;
-  iEvent.getByLabel(triggerTable_, trigRes);
+  return;
+}
 
-  EventInfo.nBitTrigger = int(triggerPathNames_.size()/32)+1;
-  for(int i=0; i<EventInfo.nBitTrigger; ++i) EventInfo.BitTrigger[i] = 0;
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::processTrig(const edm::Handle<edm::TriggerResults>& trigRes, const std::vector<int>& triggerMasks, EventInfoBranches& EventInfo) const
+{
+  const size_t nWords = EventInfo.nBitTrigger;
+
+  for (unsigned int i = 0; i < trigRes->size() && (i+1)*nWords <= triggerMasks.size(); ++i) {
+
+    if ( !trigRes->at(i).accept() ) continue;
+
+    for (size_t word = 0; word < nWords; ++word) EventInfo.BitTrigger[word] |= triggerMasks[i*nWords + word];
+  } //// Loop over trigger paths
+
+  return;
+}
+
+// ------------ method that maps the stored TaggingVariables to their JetInfoBranches columns  ------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::setupTagVarExtractors()
+{
+  using namespace reco::btau;
+
+  // per jet per track
+  ipTagVars_.addBlockVariable(trackMomentum,    &JetInfoBranches::TagVar_trackMomentum,    0);
+  ipTagVars_.addBlockVariable(trackEta,         &JetInfoBranches::TagVar_trackEta,         0);
+  ipTagVars_.addBlockVariable(trackPhi,         &JetInfoBranches::TagVar_trackPhi,         0);
+  ipTagVars_.addBlockVariable(trackPtRel,       &JetInfoBranches::TagVar_trackPtRel,       0);
+  ipTagVars_.addBlockVariable(trackPPar,        &JetInfoBranches::TagVar_trackPPar,        0);
+  ipTagVars_.addBlockVariable(trackEtaRel,      &JetInfoBranches::TagVar_trackEtaRel,      0);
+  ipTagVars_.addBlockVariable(trackDeltaR,      &JetInfoBranches::TagVar_trackDeltaR,      0);
+  ipTagVars_.addBlockVariable(trackPtRatio,     &JetInfoBranches::TagVar_trackPtRatio,     0);
+  ipTagVars_.addBlockVariable(trackPParRatio,   &JetInfoBranches::TagVar_trackPParRatio,   0);
+  ipTagVars_.addBlockVariable(trackSip2dVal,    &JetInfoBranches::TagVar_trackSip2dVal,    0);
+  ipTagVars_.addBlockVariable(trackSip2dSig,    &JetInfoBranches::TagVar_trackSip2dSig,    0);
+  ipTagVars_.addBlockVariable(trackSip3dVal,    &JetInfoBranches::TagVar_trackSip3dVal,    0);
+  ipTagVars_.addBlockVariable(trackSip3dSig,    &JetInfoBranches::TagVar_trackSip3dSig,    0);
+  ipTagVars_.addBlockVariable(trackDecayLenVal, &JetInfoBranches::TagVar_trackDecayLenVal, 0);
+  ipTagVars_.addBlockVariable(trackDecayLenSig, &JetInfoBranches::TagVar_trackDecayLenSig, 0);
+  ipTagVars_.addBlockVariable(trackJetDistVal,  &JetInfoBranches::TagVar_trackJetDistVal,  0);
+  ipTagVars_.addBlockVariable(trackJetDistSig,  &JetInfoBranches::TagVar_trackJetDistSig,  0);
+  ipTagVars_.addBlockVariable(trackChi2,        &JetInfoBranches::TagVar_trackChi2,        0);
+  ipTagVars_.addBlockVariable(trackNTotalHits,  &JetInfoBranches::TagVar_trackNTotalHits,  0);
+  ipTagVars_.addBlockVariable(trackNPixelHits,  &JetInfoBranches::TagVar_trackNPixelHits,  0);
+
+  // per jet per secondary vertex
+  svTagVars_.addBlockVariable(vertexJetDeltaR,     &JetInfoBranches::TagVar_vertexJetDeltaR,     0);
+  svTagVars_.addBlockVariable(flightDistance2dVal, &JetInfoBranches::TagVar_flightDistance2dVal, 0);
+  svTagVars_.addBlockVariable(flightDistance2dSig, &JetInfoBranches::TagVar_flightDistance2dSig, 0);
+  svTagVars_.addBlockVariable(flightDistance3dVal, &JetInfoBranches::TagVar_flightDistance3dVal, 0);
+  svTagVars_.addBlockVariable(flightDistance3dSig, &JetInfoBranches::TagVar_flightDistance3dSig, 0);
+
+  // CSV per jet
+  csvTagVars_.addJetVariable(trackJetPt,              &JetInfoBranches::TagVarCSV_trackJetPt,              -9999);
+  csvTagVars_.addJetVariable(vertexCategory,          &JetInfoBranches::TagVarCSV_vertexCategory,          -9999);
+  csvTagVars_.addJetVariable(jetNSecondaryVertices,   &JetInfoBranches::TagVarCSV_jetNSecondaryVertices,   0);
+  csvTagVars_.addJetVariable(trackSumJetEtRatio,      &JetInfoBranches::TagVarCSV_trackSumJetEtRatio,      -9999);
+  csvTagVars_.addJetVariable(trackSumJetDeltaR,       &JetInfoBranches::TagVarCSV_trackSumJetDeltaR,       -9999);
+  csvTagVars_.addJetVariable(trackSip2dValAboveCharm, &JetInfoBranches::TagVarCSV_trackSip2dValAboveCharm, -9999);
+  csvTagVars_.addJetVariable(trackSip2dSigAboveCharm, &JetInfoBranches::TagVarCSV_trackSip2dSigAboveCharm, -9999);
+  csvTagVars_.addJetVariable(trackSip3dValAboveCharm, &JetInfoBranches::TagVarCSV_trackSip3dValAboveCharm, -9999);
+  csvTagVars_.addJetVariable(trackSip3dSigAboveCharm, &JetInfoBranches::TagVarCSV_trackSip3dSigAboveCharm, -9999);
+  csvTagVars_.addJetVariable(vertexMass,              &JetInfoBranches::TagVarCSV_vertexMass,              -9999);
+  csvTagVars_.addJetVariable(vertexNTracks,           &JetInfoBranches::TagVarCSV_vertexNTracks,           0);
+  csvTagVars_.addJetVariable(vertexEnergyRatio,       &JetInfoBranches::TagVarCSV_vertexEnergyRatio,       -9999);
+  csvTagVars_.addJetVariable(vertexJetDeltaR,         &JetInfoBranches::TagVarCSV_vertexJetDeltaR,         -9999);
+  csvTagVars_.addJetVariable(flightDistance2dVal,     &JetInfoBranches::TagVarCSV_flightDistance2dVal,     -9999);
+  csvTagVars_.addJetVariable(flightDistance2dSig,     &JetInfoBranches::TagVarCSV_flightDistance2dSig,     -9999);
+  csvTagVars_.addJetVariable(flightDistance3dVal,     &JetInfoBranches::TagVarCSV_flightDistance3dVal,     -9999);
+  csvTagVars_.addJetVariable(flightDistance3dSig,     &JetInfoBranches::TagVarCSV_flightDistance3dSig,     -9999);
+
+  // CSV per jet per track
+  csvTagVars_.addBlockVariable(trackMomentum,    &JetInfoBranches::TagVarCSV_trackMomentum,    0);
+  csvTagVars_.addBlockVariable(trackEta,         &JetInfoBranches::TagVarCSV_trackEta,         0);
+  csvTagVars_.addBlockVariable(trackPhi,         &JetInfoBranches::TagVarCSV_trackPhi,         0);
+  csvTagVars_.addBlockVariable(trackPtRel,       &JetInfoBranches::TagVarCSV_trackPtRel,       0);
+  csvTagVars_.addBlockVariable(trackPPar,        &JetInfoBranches::TagVarCSV_trackPPar,        0);
+  csvTagVars_.addBlockVariable(trackDeltaR,      &JetInfoBranches::TagVarCSV_trackDeltaR,      0);
+  csvTagVars_.addBlockVariable(trackPtRatio,     &JetInfoBranches::TagVarCSV_trackPtRatio,     0);
+  csvTagVars_.addBlockVariable(trackPParRatio,   &JetInfoBranches::TagVarCSV_trackPParRatio,   0);
+  csvTagVars_.addBlockVariable(trackSip2dVal,    &JetInfoBranches::TagVarCSV_trackSip2dVal,    0);
+  csvTagVars_.addBlockVariable(trackSip2dSig,    &JetInfoBranches::TagVarCSV_trackSip2dSig,    0);
+  csvTagVars_.addBlockVariable(trackSip3dVal,    &JetInfoBranches::TagVarCSV_trackSip3dVal,    0);
+  csvTagVars_.addBlockVariable(trackSip3dSig,    &JetInfoBranches::TagVarCSV_trackSip3dSig,    0);
+  csvTagVars_.addBlockVariable(trackDecayLenVal, &JetInfoBranches::TagVarCSV_trackDecayLenVal, 0);
+  csvTagVars_.addBlockVariable(trackDecayLenSig, &JetInfoBranches::TagVarCSV_trackDecayLenSig, 0);
+  csvTagVars_.addBlockVariable(trackJetDistVal,  &JetInfoBranches::TagVarCSV_trackJetDistVal,  0);
+  csvTagVars_.addBlockVariable(trackJetDistSig,  &JetInfoBranches::TagVarCSV_trackJetDistSig,  0);
+
+  // CSV per jet per track with etaRel
+  csvTagVars_.addBlockVariable(trackEtaRel,      &JetInfoBranches::TagVarCSV_trackEtaRel,      1);
+}
+
+// ------------ method that fetches a jet tag computer and checks that it provides the CSV TaggingVariables  ------------
+template<typename IPTI,typename VTX>
+const GenericMVAJetTagComputer * BTagAnalyzerLiteT<IPTI,VTX>::getComputer(const edm::EventSetup& iSetup, const std::string& label) const
+{
+  edm::ESHandle<JetTagComputer> computerHandle;
+  iSetup.get<JetTagComputerRecord>().get( label, computerHandle );
+
+  const GenericMVAJetTagComputer * computer = dynamic_cast<const GenericMVAJetTagComputer*>( computerHandle.product() );
+  if ( !computer )
+    throw cms::Exception("Configuration") << "Jet tag computer '" << label << "' is not a GenericMVAJetTagComputer";
 
+  return computer;
+}
+
+// ------------ method that matches the paths of a new trigger menu to the TriggerPathNames patterns  ------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::updateTriggerMasks(const edm::TriggerResults& trigRes, StreamCache& cache) const
+{
   std::vector<std::string> triggerList;
   edm::Service<edm::service::TriggerNamesService> tns;
-  bool foundNames = tns->getTrigPaths(*trigRes,triggerList);
+  bool foundNames = tns->getTrigPaths(trigRes,triggerList);
   if ( !foundNames ) edm::LogError("TriggerNamesNotFound") << "Could not get trigger names!";
-  if ( trigRes->size() != triggerList.size() ) edm::LogError("TriggerPathLengthMismatch") << "Length of names and paths not the same: "
-    << triggerList.size() << "," << trigRes->size() ;
+  if ( trigRes.size() != triggerList.size() ) edm::LogError("TriggerPathLengthMismatch") << "Length of names and paths not the same: "
+    << triggerList.size() << "," << trigRes.size() ;
 
-  processTrig(trigRes, triggerList);
+  const size_t nWords = triggerPathNames_.size()/32+1;
+  const size_t nPaths = std::min<size_t>(trigRes.size(), triggerList.size());
 
-  //------------- added by Camille-----------------------------------------------------------//
-  edm::ESHandle<JetTagComputer> computerHandle;
-  iSetup.get<JetTagComputerRecord>().get( SVComputer_.c_str(), computerHandle );
+  cache.triggerMasks.assign(nPaths*nWords, 0);
+  for (size_t i = 0; i < nPaths; ++i)
+  {
+    for (size_t triggerIdx = 0; triggerIdx < triggerPathRegexes_.size(); ++triggerIdx)
+      if ( boost::regex_match(triggerList[i], triggerPathRegexes_[triggerIdx]) ) cache.triggerMasks[i*nWords + triggerIdx/32] |= ( 1 << (triggerIdx%32) );
+  }
 
-  computer = dynamic_cast<const GenericMVAJetTagComputer*>( computerHandle.product() );
-  //------------- end added-----------------------------------------------------------//
+  cache.triggerNamesID = trigRes.parameterSetID();
+}
 
-  //------------------------------------------------------
-  // Jet info
-  //------------------------------------------------------
-  int iJetColl = 0 ;
-  //// Do jets
-  processJets(jetsColl, fatjetsColl, iEvent, iSetup, groomedfatjetsColl, groomedIndices, iJetColl) ;
-  if (runSubJets_) {
-    iJetColl = 1 ;
-    // for fat jets we might have a different jet tag computer
-    // if so, grab the fat jet tag computer
-    if(SVComputerFatJets_!=SVComputer_)
-    {
-      iSetup.get<JetTagComputerRecord>().get( SVComputerFatJets_.c_str(), computerHandle );
 
-      computer = dynamic_cast<const GenericMVAJetTagComputer*>( computerHandle.product() );
-    }
-    processJets(fatjetsColl, jetsColl, iEvent, iSetup, groomedfatjetsColl, groomedIndices, iJetColl) ;
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::processJets(const edm::Handle<PatJetCollection>& jetsColl, const edm::Handle<PatJetCollection>& jetsColl2,
+                               const edm::Event& iEvent, const edm::EventSetup& iSetup,
+                               const edm::Handle<PatJetCollection>& jetsColl3, std::vector<int>& jetIndices, const int iJetColl, StreamCache& cache) const
+{
+  // the jets are processed in three steps so that they can be handled as independent tasks:
+  // first every jet is prepared (selection, CSV TaggingVariables and the number of entries it adds to each array),
+  // then the positions of the entries of each jet are assigned in the original jet order
+  // and finally each jet fills its own slice of the JetInfoBranches arrays
+  std::vector<JetRecord> & records = cache.jetRecords[iJetColl];
+  records.resize(jetsColl->size());
+
+  if ( parallelJetProcessing_ )
+    tbb::parallel_for( size_t(0), jetsColl->size(), [&](size_t iJet) { prepareJet(jetsColl, jetsColl3, jetIndices, iJet, iJetColl, cache, records[iJet]); } );
+  else
+    for ( size_t iJet = 0; iJet < jetsColl->size(); ++iJet ) prepareJet(jetsColl, jetsColl3, jetIndices, iJet, iJetColl, cache, records[iJet]);
+
+  JetInfoOffsets total;
+  for ( std::vector<JetRecord>::iterator rec = records.begin(); rec != records.end(); ++rec )
+  {
+    if ( !rec->selected ) continue;
+
+    rec->first = total;
+    total += rec->counts;
   }
-  //------------------------------------------------------
 
-  //// Fill TTree
-  if ( EventInfo.BitTrigger > 0 || EventInfo.Run < 0 ) {
-    smalltree->Fill();
+  JetInfoBranches & jetInfo = cache.buffers->JetInfo[iJetColl];
+  jetInfo.nJet                = total.nJet;
+  jetInfo.nTrack              = total.nTrack;
+  jetInfo.nSV                 = total.nSV;
+  jetInfo.nPFElectron         = total.nPFElectron;
+  jetInfo.nPFMuon             = total.nPFMuon;
+  jetInfo.nTrkTagVar          = total.nTrkTagVar;
+  jetInfo.nSVTagVar           = total.nSVTagVar;
+  jetInfo.nTrkTagVarCSV       = total.nTrkTagVarCSV;
+  jetInfo.nTrkEtaRelTagVarCSV = total.nTrkEtaRelTagVarCSV;
+  jetInfo.nSubJet             = total.nSubJet;
+
+  // the columns are grown to their final length before the jets are filled (possibly concurrently)
+  jetInfo.Fit();
+
+  // the discriminators are looked up by label only when the layout changed, the jets then read them by position
+  const std::vector<size_t> & discriminators = jetDemand_[iJetColl].discriminators;
+  std::vector<size_t> & discriminatorIndices = cache.discriminatorIndices[iJetColl];
+  if ( cache.discriminatorLayoutChanged[iJetColl] && !jetsColl->empty() )
+  {
+    cache.discriminatorLayoutChanged[iJetColl] = false;
+    discriminatorIndices.assign(discriminators.size(), size_t(-1));
+    const std::vector<std::pair<std::string, float> > & pairs = jetsColl->front().getPairDiscri();
+    for ( size_t i = 0; i < discriminators.size(); ++i )
+      for ( size_t j = 0; j < pairs.size(); ++j )
+        if ( pairs[j].first == discriminators_[discriminators[i]].label ) { discriminatorIndices[i] = j; break; }
   }
 
+  if ( parallelJetProcessing_ )
+    tbb::parallel_for( size_t(0), jetsColl->size(), [&](size_t iJet) { if ( records[iJet].selected ) fillJet(jetsColl, jetsColl2, jetsColl3, jetIndices, iJet, iJetColl, records[iJet], cache); } );
+  else
+    for ( size_t iJet = 0; iJet < jetsColl->size(); ++iJet ) if ( records[iJet].selected ) fillJet(jetsColl, jetsColl2, jetsColl3, jetIndices, iJet, iJetColl, records[iJet], cache);
+
   return;
-}
+} // BTagAnalyzerLiteT:: processJets
 
 
+// ------------ method that selects a jet and counts the entries it adds to each of the JetInfoBranches arrays  ------------
 template<typename IPTI,typename VTX>
-void BTagAnalyzerLiteT<IPTI,VTX>::processTrig(const edm::Handle<edm::TriggerResults>& trigRes, const std::vector<std::string>& triggerList)
+void BTagAnalyzerLiteT<IPTI,VTX>::prepareJet(const edm::Handle<PatJetCollection>& jetsColl, const edm::Handle<PatJetCollection>& jetsColl3,
+                                             const std::vector<int>& jetIndices, const size_t iJet, const int iJetColl,
+                                             const StreamCache& cache, JetRecord& rec) const
 {
-  for (unsigned int i = 0; i < trigRes->size(); ++i) {
+  const pat::Jet & jet = jetsColl->at(iJet);
 
-    if ( !trigRes->at(i).accept() ) continue;
+  rec.selected = !( allowJetSkipping_ && ( jet.pt() < minJetPt_ || std::fabs( jet.eta() ) > maxJetEta_ ) );
+  rec.counts = JetInfoOffsets();
+  rec.csvVars = reco::TaggingVariableList();
+  // resolved for every jet, the subjets of the fat jets are read whether they are selected or not
+  resolveTagInfos(jet, rec.tagInfos);
 
+  if ( !rec.selected ) return;
 
-    for (std::vector<std::string>::const_iterator itTrigPathNames = triggerPathNames_.begin();
-        itTrigPathNames != triggerPathNames_.end(); ++itTrigPathNames)
-    {
-      int triggerIdx = ( itTrigPathNames - triggerPathNames_.begin() );
-      int bitIdx = int(triggerIdx/32);
-      if ( NameCompatible(*itTrigPathNames,triggerList[i]) ) EventInfo.BitTrigger[bitIdx] |= ( 1 << (triggerIdx - bitIdx*32) );
-    }
-  } //// Loop over trigger names
+  rec.counts.nJet = 1;
 
-  return;
+  if( runSubJets_ && iJetColl == 0 && jet.pt()==0. ) // special treatment for pT=0 subjets
+    return;
+
+  if ( runSubJets_ && iJetColl == 1 )
+  {
+    int gfjIdx = jetIndices.at(iJet);
+    rec.counts.nSubJet = ( gfjIdx >= 0 ? jetsColl3->at(gfjIdx).numberOfDaughters() : 0 );
+  }
+
+  const IPTagInfo *ipTagInfo = toIPTagInfo(rec.tagInfos);
+  const SVTagInfo *svTagInfo = toSVTagInfo(rec.tagInfos);
+
+  if ( produceJetTrackTree_ )
+    rec.counts.nTrack = ipTagInfo->selectedTracks().size();
+
+  if ( produceJetPFLeptonTree_ )
+  {
+    rec.counts.nPFMuon     = ( rec.tagInfos.softPFMu ? rec.tagInfos.softPFMu->leptons() : 0 );
+    rec.counts.nPFElectron = ( rec.tagInfos.softPFEl ? rec.tagInfos.softPFEl->leptons() : 0 );
+  }
+
+  if ( storeTagVariables_ )
+  {
+    rec.counts.nTrkTagVar = ipTagInfo->selectedTracks().size();
+    rec.counts.nSVTagVar  = svTagInfo->nVertices();
+  }
+
+  if ( storeCSVTagVariables_ && jetDemand_[iJetColl].csvTagVariables )
+  {
+    std::vector<const reco::BaseTagInfo*>  baseTagInfos;
+    JetTagComputer::TagInfoHelper helper(baseTagInfos);
+    baseTagInfos.push_back( ipTagInfo );
+    baseTagInfos.push_back( svTagInfo );
+    // TaggingVariables
+    rec.csvVars = cache.computer->taggingVariables(helper);
+
+    rec.counts.nTrkTagVarCSV       = BTagAnalyzerLiteTagVarExtractor::count(rec.csvVars, reco::btau::trackSip2dSig);
+    rec.counts.nTrkEtaRelTagVarCSV = BTagAnalyzerLiteTagVarExtractor::count(rec.csvVars, reco::btau::trackEtaRel);
+  }
+
+  rec.counts.nSV = svTagInfo->nVertices();
 }
 
 
+// ------------ method that fills the JetInfoBranches entries of a single jet  ------------
 template<typename IPTI,typename VTX>
-void BTagAnalyzerLiteT<IPTI,VTX>::processJets(const edm::Handle<PatJetCollection>& jetsColl, const edm::Handle<PatJetCollection>& jetsColl2,
-                               const edm::Event& iEvent, const edm::EventSetup& iSetup,
-                               const edm::Handle<PatJetCollection>& jetsColl3, std::vector<int>& jetIndices, const int iJetColl)
+void BTagAnalyzerLiteT<IPTI,VTX>::fillJet(const edm::Handle<PatJetCollection>& jetsColl, const edm::Handle<PatJetCollection>& jetsColl2,
+                                          const edm::Handle<PatJetCollection>& jetsColl3, const std::vector<int>& jetIndices,
+                                          const size_t iJet, const int iJetColl, const JetRecord& rec, StreamCache& cache) const
 {
+  // per-stream buffers
+  JetInfoBranches * JetInfo = cache.buffers->JetInfo;
+  const reco::Vertex *pv = cache.pv;
+  // per-thread PF jet ID and N-subjettiness tools
+  BTagAnalyzerLiteJetTools & jetTools = cache.jetTools.local();
 
-  JetInfo[iJetColl].nPFElectron = 0;
-  JetInfo[iJetColl].nPFMuon = 0;
-
-  JetInfo[iJetColl].nJet = 0;
-  JetInfo[iJetColl].nTrack = 0;
-  JetInfo[iJetColl].nSV = 0;
-  JetInfo[iJetColl].nTrkTagVar = 0;
-  JetInfo[iJetColl].nSVTagVar = 0;
-  JetInfo[iJetColl].nTrkTagVarCSV = 0;
-  JetInfo[iJetColl].nTrkEtaRelTagVarCSV = 0;
-  JetInfo[iJetColl].nSubJet = 0;
+  // positions of the next entries of this jet in the JetInfoBranches arrays
+  JetInfoOffsets pos = rec.first;
 
-  //// Loop over the jets
-  for ( PatJetCollection::const_iterator pjet = jetsColl->begin(); pjet != jetsColl->end(); ++pjet ) {
+  PatJetCollection::const_iterator pjet = jetsColl->begin() + iJet;
 
-    double ptjet  = pjet->pt()  ;
-    double etajet = pjet->eta() ;
-    //double phijet = pjet->phi() ;
+  double ptjet  = pjet->pt()  ;
+  //double etajet = pjet->eta() ;
+  //double phijet = pjet->phi() ;
 
-    if ( allowJetSkipping_ && ( ptjet < minJetPt_ || std::fabs( etajet ) > maxJetEta_ ) ) continue;
+  int flavour  =-1  ;
+  if ( !cache.isData ) {
+    flavour = abs( pjet->partonFlavour() );
+    if ( flavour >= 1 && flavour <= 3 ) flavour = 1;
+  }
 
-    int flavour  =-1  ;
-    if ( !isData_ ) {
-      flavour = abs( pjet->partonFlavour() );
-      if ( flavour >= 1 && flavour <= 3 ) flavour = 1;
-    }
+  JetInfo[iJetColl].Jet_flavour[pos.nJet]   = pjet->partonFlavour();
+  JetInfo[iJetColl].Jet_nbHadrons[pos.nJet] = pjet->jetFlavourInfo().getbHadrons().size();
+  JetInfo[iJetColl].Jet_ncHadrons[pos.nJet] = pjet->jetFlavourInfo().getcHadrons().size();
+  JetInfo[iJetColl].Jet_eta[pos.nJet]       = pjet->eta();
+  JetInfo[iJetColl].Jet_phi[pos.nJet]       = pjet->phi();
+  JetInfo[iJetColl].Jet_pt[pos.nJet]        = pjet->pt();
+  JetInfo[iJetColl].Jet_mass[pos.nJet]      = pjet->mass();
+  JetInfo[iJetColl].Jet_genpt[pos.nJet]     = ( pjet->genJet()!=0 ? pjet->genJet()->pt() : -1. );
+
+  // JEC factors of the jet (available JEC sets)
+  const BTagAnalyzerLiteJECFactors & jec = cache.jecFactors[iJetColl];
+  const size_t jecIdx = pjet - jetsColl->begin();
+  const bool jecSets = jec.available(jecIdx);
+  // PF jet ID
+  pat::strbitset retpf = jetTools.pfjetIDLoose.getBitTemplate();
+  retpf.set(false);
+  JetInfo[iJetColl].Jet_looseID[pos.nJet]  = ( ( jecSets && pjet->isPFJet() ) ? ( jetTools.pfjetIDLoose( *pjet, retpf ) ? 1 : 0 ) : 0 );
+  retpf.set(false);
+  JetInfo[iJetColl].Jet_tightID[pos.nJet]  = ( ( jecSets && pjet->isPFJet() ) ? ( jetTools.pfjetIDTight( *pjet, retpf ) ? 1 : 0 ) : 0 );
+
+  JetInfo[iJetColl].Jet_jes[pos.nJet]      = ( jecSets ? 1./jec(jecIdx, BTagAnalyzerLiteJECFactors::Uncorrected) : 1. );
+  JetInfo[iJetColl].Jet_residual[pos.nJet] = ( jecSets ? 1./jec(jecIdx, BTagAnalyzerLiteJECFactors::L3Absolute) : 1. );
+
+  if( runSubJets_ && iJetColl == 0 )
+  {
+    JetInfo[iJetColl].Jet_FatJetIdx[pos.nJet] = cache.subJetTable.fatJet.at( pjet - jetsColl->begin() );
 
-    JetInfo[iJetColl].Jet_flavour[JetInfo[iJetColl].nJet]   = pjet->partonFlavour();
-    JetInfo[iJetColl].Jet_nbHadrons[JetInfo[iJetColl].nJet] = pjet->jetFlavourInfo().getbHadrons().size();
-    JetInfo[iJetColl].Jet_ncHadrons[JetInfo[iJetColl].nJet] = pjet->jetFlavourInfo().getcHadrons().size();
-    JetInfo[iJetColl].Jet_eta[JetInfo[iJetColl].nJet]       = pjet->eta();
-    JetInfo[iJetColl].Jet_phi[JetInfo[iJetColl].nJet]       = pjet->phi();
-    JetInfo[iJetColl].Jet_pt[JetInfo[iJetColl].nJet]        = pjet->pt();
-    JetInfo[iJetColl].Jet_mass[JetInfo[iJetColl].nJet]      = pjet->mass();
-    JetInfo[iJetColl].Jet_genpt[JetInfo[iJetColl].nJet]     = ( pjet->genJet()!=0 ? pjet->genJet()->pt() : -1. );
-
-    // available JEC sets
-    unsigned int nJECSets = pjet->availableJECSets().size();
-    // PF jet ID
-    pat::strbitset retpf = pfjetIDLoose_.getBitTemplate();
-    retpf.set(false);
-    JetInfo[iJetColl].Jet_looseID[JetInfo[iJetColl].nJet]  = ( ( nJECSets>0 && pjet->isPFJet() ) ? ( pfjetIDLoose_( *pjet, retpf ) ? 1 : 0 ) : 0 );
-    retpf.set(false);
-    JetInfo[iJetColl].Jet_tightID[JetInfo[iJetColl].nJet]  = ( ( nJECSets>0 && pjet->isPFJet() ) ? ( pfjetIDTight_( *pjet, retpf ) ? 1 : 0 ) : 0 );
-
-    JetInfo[iJetColl].Jet_jes[JetInfo[iJetColl].nJet]      = ( nJECSets>0 ? pjet->pt()/pjet->correctedJet("Uncorrected").pt() : 1. );
-    JetInfo[iJetColl].Jet_residual[JetInfo[iJetColl].nJet] = ( nJECSets>0 ? pjet->pt()/pjet->correctedJet("L3Absolute").pt() : 1. );
-
-    if( runSubJets_ && iJetColl == 0 )
+    if( ptjet==0. ) // special treatment for pT=0 subjets
     {
-      int fatjetIdx=-1;
-      bool fatJetFound = false;
-      // loop over fat jets
-      for( int fjIt = 0; fjIt < (int)jetIndices.size(); ++fjIt )
-      {
-        int gfjIdx = jetIndices.at(fjIt);
-        if( gfjIdx < 0 ) // skip fat jets with no matching groomed fat jet
-          continue;
-
-        int nSJ = jetsColl3->at(gfjIdx).numberOfDaughters();
-        const edm::Ptr<reco::Jet> originalObjRef = edm::Ptr<reco::Jet>( jetsColl3->at(gfjIdx).originalObjectRef() );
-        // loop over subjets
-        for( int sjIt = 0; sjIt < nSJ; ++sjIt )
-        {
-          if( pjet->originalObjectRef() == originalObjRef->daughterPtr(sjIt) )
-          {
-            fatjetIdx = fjIt;
-            fatJetFound = true;
-            break;
-          }
-        }
-        if( fatJetFound )
-          break;
-      }
-      JetInfo[iJetColl].Jet_FatJetIdx[JetInfo[iJetColl].nJet] = fatjetIdx;
-
-      if( ptjet==0. ) // special treatment for pT=0 subjets
-      {
-        ++JetInfo[iJetColl].nJet;
-        continue;
-      }
+      return;
     }
+  }
 
-    int subjet1Idx = -1, subjet2Idx = -1;
-
-    if ( runSubJets_ && iJetColl == 1 )
-    {
-      // N-subjettiness
-      JetInfo[iJetColl].Jet_tau1[JetInfo[iJetColl].nJet] = pjet->userFloat("Njettiness:tau1");
-      JetInfo[iJetColl].Jet_tau2[JetInfo[iJetColl].nJet] = pjet->userFloat("Njettiness:tau2");
+  int subjet1Idx = -1, subjet2Idx = -1;
 
-      int gfjIdx = jetIndices.at( pjet - jetsColl->begin() );
-      int nSJ = 0;
-      JetInfo[iJetColl].Jet_nFirstSJ[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nSubJet;
-      std::vector<PatJetCollection::const_iterator> subjetIters;
+  if ( runSubJets_ && iJetColl == 1 )
+  {
+    // N-subjettiness
+    JetInfo[iJetColl].Jet_tau1[pos.nJet] = pjet->userFloat("Njettiness:tau1");
+    JetInfo[iJetColl].Jet_tau2[pos.nJet] = pjet->userFloat("Njettiness:tau2");
 
-      if ( gfjIdx >= 0 )
-      {
-        nSJ = jetsColl3->at(gfjIdx).numberOfDaughters();
+    int gfjIdx = jetIndices.at( pjet - jetsColl->begin() );
+    int nSJ = 0;
+    JetInfo[iJetColl].Jet_nFirstSJ[pos.nJet] = pos.nSubJet;
+    std::vector<PatJetCollection::const_iterator> subjetIters;
 
-        JetInfo[iJetColl].Jet_ptGroomed[JetInfo[iJetColl].nJet]   = jetsColl3->at(gfjIdx).pt();
-        JetInfo[iJetColl].Jet_jesGroomed[JetInfo[iJetColl].nJet]  = jetsColl3->at(gfjIdx).pt()/jetsColl3->at(gfjIdx).correctedJet("Uncorrected").pt();
-        JetInfo[iJetColl].Jet_etaGroomed[JetInfo[iJetColl].nJet]  = jetsColl3->at(gfjIdx).eta();
-        JetInfo[iJetColl].Jet_phiGroomed[JetInfo[iJetColl].nJet]  = jetsColl3->at(gfjIdx).phi();
-        JetInfo[iJetColl].Jet_massGroomed[JetInfo[iJetColl].nJet] = jetsColl3->at(gfjIdx).mass();
+    if ( gfjIdx >= 0 )
+    {
+      nSJ = jetsColl3->at(gfjIdx).numberOfDaughters();
 
-        const edm::Ptr<reco::Jet> originalObjRef = edm::Ptr<reco::Jet>( jetsColl3->at(gfjIdx).originalObjectRef() );
-        // loop over subjets
-        for( int sjIt = 0; sjIt < nSJ; ++sjIt )
-        {
-          JetInfo[iJetColl].SubJetIdx[JetInfo[iJetColl].nSubJet] = -1;
+      JetInfo[iJetColl].Jet_ptGroomed[pos.nJet]   = jetsColl3->at(gfjIdx).pt();
+      JetInfo[iJetColl].Jet_jesGroomed[pos.nJet]  = 1./cache.jecFactors[2](gfjIdx, BTagAnalyzerLiteJECFactors::Uncorrected);
+      JetInfo[iJetColl].Jet_etaGroomed[pos.nJet]  = jetsColl3->at(gfjIdx).eta();
+      JetInfo[iJetColl].Jet_phiGroomed[pos.nJet]  = jetsColl3->at(gfjIdx).phi();
+      JetInfo[iJetColl].Jet_massGroomed[pos.nJet] = jetsColl3->at(gfjIdx).mass();
 
-          for( PatJetCollection::const_iterator jIt = jetsColl2->begin(); jIt != jetsColl2->end(); ++jIt )
-          {
-            if( jIt->originalObjectRef() == originalObjRef->daughterPtr(sjIt) )
-            {
-              JetInfo[iJetColl].SubJetIdx[JetInfo[iJetColl].nSubJet] = ( jIt - jetsColl2->begin() );
-              subjetIters.push_back( jIt );
-              break;
-            }
-          }
-          ++JetInfo[iJetColl].nSubJet;
-        }
-      }
-      else
+      const std::vector<int> & subJets = cache.subJetTable.subJets.at( pjet - jetsColl->begin() );
+      // loop over subjets
+      for( int sjIt = 0; sjIt < nSJ; ++sjIt )
       {
-        JetInfo[iJetColl].Jet_ptGroomed[JetInfo[iJetColl].nJet]   = -9999;
-        JetInfo[iJetColl].Jet_jesGroomed[JetInfo[iJetColl].nJet]  = -9999;
-        JetInfo[iJetColl].Jet_etaGroomed[JetInfo[iJetColl].nJet]  = -9999;
-        JetInfo[iJetColl].Jet_phiGroomed[JetInfo[iJetColl].nJet]  = -9999;
-        JetInfo[iJetColl].Jet_massGroomed[JetInfo[iJetColl].nJet] = -9999;
+        JetInfo[iJetColl].SubJetIdx[pos.nSubJet] = subJets.at(sjIt);
+        if( subJets.at(sjIt) >= 0 ) subjetIters.push_back( jetsColl2->begin() + subJets.at(sjIt) );
+        ++pos.nSubJet;
       }
-      JetInfo[iJetColl].Jet_nSubJets[JetInfo[iJetColl].nJet] = nSJ;
-      JetInfo[iJetColl].Jet_nLastSJ[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nSubJet;
+    }
+    else
+    {
+      JetInfo[iJetColl].Jet_ptGroomed[pos.nJet]   = -9999;
+      JetInfo[iJetColl].Jet_jesGroomed[pos.nJet]  = -9999;
+      JetInfo[iJetColl].Jet_etaGroomed[pos.nJet]  = -9999;
+      JetInfo[iJetColl].Jet_phiGroomed[pos.nJet]  = -9999;
+      JetInfo[iJetColl].Jet_massGroomed[pos.nJet] = -9999;
+    }
+    JetInfo[iJetColl].Jet_nSubJets[pos.nJet] = nSJ;
+    JetInfo[iJetColl].Jet_nLastSJ[pos.nJet] = pos.nSubJet;
 
-      // sort subjets by uncorrected Pt
-      std::sort(subjetIters.begin(), subjetIters.end(), orderByPt("Uncorrected"));
-      // take two leading subjets
-      if( subjetIters.size()>1 )
-      {
-         subjet1Idx = ( subjetIters.at(0) - jetsColl2->begin() );
-         subjet2Idx = ( subjetIters.at(1) - jetsColl2->begin() );
-      }
+    // sort subjets by uncorrected Pt
+    std::sort(subjetIters.begin(), subjetIters.end(), orderByPt(jetsColl2->begin(), cache.jecFactors[0], BTagAnalyzerLiteJECFactors::Uncorrected));
+    // take two leading subjets
+    if( subjetIters.size()>1 )
+    {
+       subjet1Idx = ( subjetIters.at(0) - jetsColl2->begin() );
+       subjet2Idx = ( subjetIters.at(1) - jetsColl2->begin() );
+    }
 
-      int nsubjettracks = 0, nsharedsubjettracks = 0;
+    int nsubjettracks = 0, nsharedsubjettracks = 0;
 
-      if( subjet1Idx>=0 && subjet2Idx>=0 ) // protection for pathological cases of groomed fat jets with only one constituent which results in an undefined subjet 2 index
+    if( subjet1Idx>=0 && subjet2Idx>=0 ) // protection for pathological cases of groomed fat jets with only one constituent which results in an undefined subjet 2 index
+    {
+      for(int sj=0; sj<2; ++sj)
       {
-        for(int sj=0; sj<2; ++sj)
-        {
-          int subjetIdx = (sj==0 ? subjet1Idx : subjet2Idx); // subjet index
-          int compSubjetIdx = (sj==0 ? subjet2Idx : subjet1Idx); // companion subjet index
-          int nTracks = ( jetsColl2->at(subjetIdx).hasTagInfo(ipTagInfos_.c_str()) ? toIPTagInfo(jetsColl2->at(subjetIdx),ipTagInfos_)->selectedTracks().size() : 0 );
+        int subjetIdx = (sj==0 ? subjet1Idx : subjet2Idx); // subjet index
+        int compSubjetIdx = (sj==0 ? subjet2Idx : subjet1Idx); // companion subjet index
+        // TagInfos of the subjet, resolved when the subjet collection was processed
+        const IPTagInfo *subjetIPTagInfo = toIPTagInfo( cache.jetRecords[0].at(subjetIdx).tagInfos );
+        int nTracks = ( subjetIPTagInfo ? subjetIPTagInfo->selectedTracks().size() : 0 );
 
-          for(int t=0; t<nTracks; ++t)
+        for(int t=0; t<nTracks; ++t)
+        {
+          const double trackEta = subjetIPTagInfo->selectedTracks().at(t)->eta();
+          const double trackPhi = subjetIPTagInfo->selectedTracks().at(t)->phi();
+          if( reco::deltaR( trackEta, trackPhi, jetsColl2->at(subjetIdx).eta(), jetsColl2->at(subjetIdx).phi() ) < 0.3 )
           {
-            if( reco::deltaR( toIPTagInfo(jetsColl2->at(subjetIdx),ipTagInfos_)->selectedTracks().at(t)->eta(), toIPTagInfo(jetsColl2->at(subjetIdx),ipTagInfos_)->selectedTracks().at(t)->phi(), jetsColl2->at(subjetIdx).eta(), jetsColl2->at(subjetIdx).phi() ) < 0.3 )
+            ++nsubjettracks;
+            if( reco::deltaR( trackEta, trackPhi, jetsColl2->at(compSubjetIdx).eta(), jetsColl2->at(compSubjetIdx).phi() ) < 0.3 )
             {
-              ++nsubjettracks;
-              if( reco::deltaR( toIPTagInfo(jetsColl2->at(subjetIdx),ipTagInfos_)->selectedTracks().at(t)->eta(), toIPTagInfo(jetsColl2->at(subjetIdx),ipTagInfos_)->selectedTracks().at(t)->phi(), jetsColl2->at(compSubjetIdx).eta(), jetsColl2->at(compSubjetIdx).phi() ) < 0.3 )
-              {
-                if(sj==0) ++nsharedsubjettracks;
-              }
+              if(sj==0) ++nsharedsubjettracks;
             }
           }
         }
       }
-
-      JetInfo[iJetColl].Jet_nsubjettracks[JetInfo[iJetColl].nJet] = nsubjettracks-nsharedsubjettracks;
-      JetInfo[iJetColl].Jet_nsharedsubjettracks[JetInfo[iJetColl].nJet] = nsharedsubjettracks;
     }
 
-    // Get all TagInfo pointers
-    const IPTagInfo *ipTagInfo = toIPTagInfo(*pjet,ipTagInfos_);
-    const SVTagInfo *svTagInfo = toSVTagInfo(*pjet,svTagInfos_);
-    const reco::CandSoftLeptonTagInfo *softPFMuTagInfo = pjet->tagInfoCandSoftLepton(softPFMuonTagInfos_.c_str());
-    const reco::CandSoftLeptonTagInfo *softPFElTagInfo = pjet->tagInfoCandSoftLepton(softPFElectronTagInfos_.c_str());
+    JetInfo[iJetColl].Jet_nsubjettracks[pos.nJet] = nsubjettracks-nsharedsubjettracks;
+    JetInfo[iJetColl].Jet_nsharedsubjettracks[pos.nJet] = nsharedsubjettracks;
+  }
 
-    // Re-calculate N-subjettiness using IVF vertices as composite b candidates
-    if ( runSubJets_ && iJetColl == 1 )
-    {
-      float tau1IVF = JetInfo[iJetColl].Jet_tau1[JetInfo[iJetColl].nJet];
-      float tau2IVF = JetInfo[iJetColl].Jet_tau2[JetInfo[iJetColl].nJet];
+  // Get all TagInfo pointers (resolved in prepareJet)
+  const IPTagInfo *ipTagInfo = toIPTagInfo(rec.tagInfos);
+  const SVTagInfo *svTagInfo = toSVTagInfo(rec.tagInfos);
+  const reco::CandSoftLeptonTagInfo *softPFMuTagInfo = rec.tagInfos.softPFMu;
+  const reco::CandSoftLeptonTagInfo *softPFElTagInfo = rec.tagInfos.softPFEl;
 
-      // re-calculate N-subjettiness
-      recalcNsubjettiness(*pjet,*svTagInfo,tau1IVF,tau2IVF);
+  // secondary vertex of the jet tracks, shared by the N-subjettiness re-calculation and the track loop
+  const bool nsubjettinessIVF = ( runSubJets_ && iJetColl == 1 && jetDemand_[iJetColl].nsubjettinessIVF );
+  if ( svTagInfo && ( nsubjettinessIVF || jetDemand_[iJetColl].tracksSV ) )
+    jetTools.trackSVs.fillSV(*svTagInfo);
 
-      // store re-calculated N-subjettiness
-      JetInfo[iJetColl].Jet_tau1IVF[JetInfo[iJetColl].nJet] = tau1IVF;
-      JetInfo[iJetColl].Jet_tau2IVF[JetInfo[iJetColl].nJet] = tau2IVF;
-    }
+  // Re-calculate N-subjettiness using IVF vertices as composite b candidates
+  if ( nsubjettinessIVF )
+  {
+    float tau1IVF = JetInfo[iJetColl].Jet_tau1[pos.nJet];
+    float tau2IVF = JetInfo[iJetColl].Jet_tau2[pos.nJet];
+
+    // re-calculate N-subjettiness
+    recalcNsubjettiness(*pjet,*svTagInfo,jetTools.trackSVs,jetTools.njettiness,tau1IVF,tau2IVF);
+
+    // store re-calculated N-subjettiness
+    JetInfo[iJetColl].Jet_tau1IVF[pos.nJet] = tau1IVF;
+    JetInfo[iJetColl].Jet_tau2IVF[pos.nJet] = tau2IVF;
+  }
 
-    //*****************************************************************
-    // Taggers
-    //*****************************************************************
+  //*****************************************************************
+  // Taggers
+  //*****************************************************************
 
-    // Loop on Selected Tracks
-    JetInfo[iJetColl].Jet_ntracks[JetInfo[iJetColl].nJet] = 0;
+  // Loop on Selected Tracks
+  JetInfo[iJetColl].Jet_ntracks[pos.nJet] = 0;
 
-    int nseltracks = 0;
-    int nsharedtracks = 0;
-    reco::TrackKinematics allKinematics;
+  int nseltracks = 0;
+  int nsharedtracks = 0;
+  reco::TrackKinematics allKinematics;
 	
 
-    if ( produceJetTrackTree_ )
-    {
-      const Tracks & selectedTracks( ipTagInfo->selectedTracks() );
+  if ( produceJetTrackTree_ )
+  {
+    const Tracks & selectedTracks( ipTagInfo->selectedTracks() );
 
-      JetInfo[iJetColl].Jet_ntracks[JetInfo[iJetColl].nJet] = selectedTracks.size();
+    JetInfo[iJetColl].Jet_ntracks[pos.nJet] = selectedTracks.size();
 
-      JetInfo[iJetColl].Jet_nFirstTrack[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nTrack;
+    JetInfo[iJetColl].Jet_nFirstTrack[pos.nJet] = pos.nTrack;
 
-      unsigned int trackSize = selectedTracks.size();
+    unsigned int trackSize = selectedTracks.size();
 
-      for (unsigned int itt=0; itt < trackSize; ++itt)
-      {
-        const reco::Track & ptrack = *(reco::btag::toTrack(selectedTracks[itt]));
-        const TrackRef ptrackRef = selectedTracks[itt];
+    for (unsigned int itt=0; itt < trackSize; ++itt)
+    {
+      const reco::Track & ptrack = *(reco::btag::toTrack(selectedTracks[itt]));
+      const TrackRef ptrackRef = selectedTracks[itt];
 
-        //--------------------------------
-        float decayLength = (ipTagInfo->impactParameterData()[itt].closestToJetAxis - RecoVertex::convertPos(pv->position())).mag();
-        float distJetAxis = ipTagInfo->impactParameterData()[itt].distanceToJetAxis.value();
+      //--------------------------------
+      float decayLength = (ipTagInfo->impactParameterData()[itt].closestToJetAxis - RecoVertex::convertPos(pv->position())).mag();
+      float distJetAxis = ipTagInfo->impactParameterData()[itt].distanceToJetAxis.value();
 
-        JetInfo[iJetColl].Track_dist[JetInfo[iJetColl].nTrack]     = distJetAxis;
-        JetInfo[iJetColl].Track_length[JetInfo[iJetColl].nTrack]   = decayLength;
+      JetInfo[iJetColl].Track_dist[pos.nTrack]     = distJetAxis;
+      JetInfo[iJetColl].Track_length[pos.nTrack]   = decayLength;
 
-        JetInfo[iJetColl].Track_dxy[JetInfo[iJetColl].nTrack]      = ptrack.dxy(pv->position());
-        JetInfo[iJetColl].Track_dz[JetInfo[iJetColl].nTrack]       = ptrack.dz(pv->position());
-        JetInfo[iJetColl].Track_zIP[JetInfo[iJetColl].nTrack]      = ptrack.dz()-(*pv).z();
+      JetInfo[iJetColl].Track_dxy[pos.nTrack]      = ptrack.dxy(pv->position());
+      JetInfo[iJetColl].Track_dz[pos.nTrack]       = ptrack.dz(pv->position());
+      JetInfo[iJetColl].Track_zIP[pos.nTrack]      = ptrack.dz()-(*pv).z();
 
-        float deltaR = reco::deltaR( ptrack.eta(), ptrack.phi(),
-                                     JetInfo[iJetColl].Jet_eta[JetInfo[iJetColl].nJet], JetInfo[iJetColl].Jet_phi[JetInfo[iJetColl].nJet] );
+      float deltaR = reco::deltaR( ptrack.eta(), ptrack.phi(),
+                                   JetInfo[iJetColl].Jet_eta[pos.nJet], JetInfo[iJetColl].Jet_phi[pos.nJet] );
 
-        if (deltaR < 0.3) nseltracks++;
+      if (deltaR < 0.3) nseltracks++;
 
-        if ( runSubJets_ && iJetColl == 1 && subjet1Idx >= 0 && subjet2Idx >= 0 ) {
+      if ( runSubJets_ && iJetColl == 1 && subjet1Idx >= 0 && subjet2Idx >= 0 ) {
 
-          float dR1 = reco::deltaR( ptrack.eta(), ptrack.phi(),
-                                    JetInfo[0].Jet_eta[subjet1Idx], JetInfo[0].Jet_phi[subjet1Idx] );
+        // the subjet indices refer to the subjet collection, not to the (possibly skimmed) subjet columns
+        float dR1 = reco::deltaR( ptrack.eta(), ptrack.phi(),
+                                  jetsColl2->at(subjet1Idx).eta(), jetsColl2->at(subjet1Idx).phi() );
 
-          float dR2 = reco::deltaR( ptrack.eta(), ptrack.phi(),
-                                    JetInfo[0].Jet_eta[subjet2Idx], JetInfo[0].Jet_phi[subjet2Idx] );
+        float dR2 = reco::deltaR( ptrack.eta(), ptrack.phi(),
+                                  jetsColl2->at(subjet2Idx).eta(), jetsColl2->at(subjet2Idx).phi() );
 
-          if ( dR1 < 0.3 && dR2 < 0.3 ) nsharedtracks++;
-        }
+        if ( dR1 < 0.3 && dR2 < 0.3 ) nsharedtracks++;
+      }
 
-        JetInfo[iJetColl].Track_IP2D[JetInfo[iJetColl].nTrack]     = ipTagInfo->impactParameterData()[itt].ip2d.value();
-        JetInfo[iJetColl].Track_IP2Dsig[JetInfo[iJetColl].nTrack]  = ipTagInfo->impactParameterData()[itt].ip2d.significance();
-        JetInfo[iJetColl].Track_IP[JetInfo[iJetColl].nTrack]       = ipTagInfo->impactParameterData()[itt].ip3d.value();
-        JetInfo[iJetColl].Track_IPsig[JetInfo[iJetColl].nTrack]    = ipTagInfo->impactParameterData()[itt].ip3d.significance();
-        JetInfo[iJetColl].Track_IP2Derr[JetInfo[iJetColl].nTrack]  = ipTagInfo->impactParameterData()[itt].ip2d.error();
-        JetInfo[iJetColl].Track_IPerr[JetInfo[iJetColl].nTrack]    = ipTagInfo->impactParameterData()[itt].ip3d.error();
-        JetInfo[iJetColl].Track_Proba[JetInfo[iJetColl].nTrack]    = ipTagInfo->probabilities(0)[itt];
-
-        JetInfo[iJetColl].Track_p[JetInfo[iJetColl].nTrack]        = ptrack.p();
-        JetInfo[iJetColl].Track_pt[JetInfo[iJetColl].nTrack]       = ptrack.pt();
-        JetInfo[iJetColl].Track_eta[JetInfo[iJetColl].nTrack]      = ptrack.eta();
-        JetInfo[iJetColl].Track_phi[JetInfo[iJetColl].nTrack]      = ptrack.phi();
-        JetInfo[iJetColl].Track_chi2[JetInfo[iJetColl].nTrack]     = ptrack.normalizedChi2();
-        JetInfo[iJetColl].Track_charge[JetInfo[iJetColl].nTrack]   = ptrack.charge();
-
-        JetInfo[iJetColl].Track_nHitAll[JetInfo[iJetColl].nTrack]  = ptrack.numberOfValidHits();
-        JetInfo[iJetColl].Track_nHitPixel[JetInfo[iJetColl].nTrack]= ptrack.hitPattern().numberOfValidPixelHits();
-        JetInfo[iJetColl].Track_nHitStrip[JetInfo[iJetColl].nTrack]= ptrack.hitPattern().numberOfValidStripHits();
-        JetInfo[iJetColl].Track_nHitTIB[JetInfo[iJetColl].nTrack]  = ptrack.hitPattern().numberOfValidStripTIBHits();
-        JetInfo[iJetColl].Track_nHitTID[JetInfo[iJetColl].nTrack]  = ptrack.hitPattern().numberOfValidStripTIDHits();
-        JetInfo[iJetColl].Track_nHitTOB[JetInfo[iJetColl].nTrack]  = ptrack.hitPattern().numberOfValidStripTOBHits();
-        JetInfo[iJetColl].Track_nHitTEC[JetInfo[iJetColl].nTrack]  = ptrack.hitPattern().numberOfValidStripTECHits();
-        JetInfo[iJetColl].Track_nHitPXB[JetInfo[iJetColl].nTrack]  = ptrack.hitPattern().numberOfValidPixelBarrelHits();
-        JetInfo[iJetColl].Track_nHitPXF[JetInfo[iJetColl].nTrack]  = ptrack.hitPattern().numberOfValidPixelEndcapHits();
-        JetInfo[iJetColl].Track_isHitL1[JetInfo[iJetColl].nTrack]  = ptrack.hitPattern().hasValidHitInFirstPixelBarrel();
-
-        setTracksPV(ptrackRef, primaryVertex,
-                    JetInfo[iJetColl].Track_PV[JetInfo[iJetColl].nTrack],
-                    JetInfo[iJetColl].Track_PVweight[JetInfo[iJetColl].nTrack]);
-	
-	if(JetInfo[iJetColl].Track_PVweight[JetInfo[iJetColl].nTrack]>0) { allKinematics.add(ptrack, JetInfo[iJetColl].Track_PVweight[JetInfo[iJetColl].nTrack]); }
+      JetInfo[iJetColl].Track_IP2D[pos.nTrack]     = ipTagInfo->impactParameterData()[itt].ip2d.value();
+      JetInfo[iJetColl].Track_IP2Dsig[pos.nTrack]  = ipTagInfo->impactParameterData()[itt].ip2d.significance();
+      JetInfo[iJetColl].Track_IP[pos.nTrack]       = ipTagInfo->impactParameterData()[itt].ip3d.value();
+      JetInfo[iJetColl].Track_IPsig[pos.nTrack]    = ipTagInfo->impactParameterData()[itt].ip3d.significance();
+      JetInfo[iJetColl].Track_IP2Derr[pos.nTrack]  = ipTagInfo->impactParameterData()[itt].ip2d.error();
+      JetInfo[iJetColl].Track_IPerr[pos.nTrack]    = ipTagInfo->impactParameterData()[itt].ip3d.error();
+      JetInfo[iJetColl].Track_Proba[pos.nTrack]    = ipTagInfo->probabilities(0)[itt];
+
+      JetInfo[iJetColl].Track_p[pos.nTrack]        = ptrack.p();
+      JetInfo[iJetColl].Track_pt[pos.nTrack]       = ptrack.pt();
+      JetInfo[iJetColl].Track_eta[pos.nTrack]      = ptrack.eta();
+      JetInfo[iJetColl].Track_phi[pos.nTrack]      = ptrack.phi();
+      JetInfo[iJetColl].Track_chi2[pos.nTrack]     = ptrack.normalizedChi2();
+      JetInfo[iJetColl].Track_charge[pos.nTrack]   = ptrack.charge();
+
+      JetInfo[iJetColl].Track_nHitAll[pos.nTrack]  = ptrack.numberOfValidHits();
+      JetInfo[iJetColl].Track_nHitPixel[pos.nTrack]= ptrack.hitPattern().numberOfValidPixelHits();
+      JetInfo[iJetColl].Track_nHitStrip[pos.nTrack]= ptrack.hitPattern().numberOfValidStripHits();
+      JetInfo[iJetColl].Track_nHitTIB[pos.nTrack]  = ptrack.hitPattern().numberOfValidStripTIBHits();
+      JetInfo[iJetColl].Track_nHitTID[pos.nTrack]  = ptrack.hitPattern().numberOfValidStripTIDHits();
+      JetInfo[iJetColl].Track_nHitTOB[pos.nTrack]  = ptrack.hitPattern().numberOfValidStripTOBHits();
+      JetInfo[iJetColl].Track_nHitTEC[pos.nTrack]  = ptrack.hitPattern().numberOfValidStripTECHits();
+      JetInfo[iJetColl].Track_nHitPXB[pos.nTrack]  = ptrack.hitPattern().numberOfValidPixelBarrelHits();
+      JetInfo[iJetColl].Track_nHitPXF[pos.nTrack]  = ptrack.hitPattern().numberOfValidPixelEndcapHits();
+      JetInfo[iJetColl].Track_isHitL1[pos.nTrack]  = ptrack.hitPattern().hasValidHitInFirstPixelBarrel();
+
+      if ( jetDemand_[iJetColl].tracksPV )
+      {
+        setTracksPV(ptrackRef, cache.trackPVs,
+                    JetInfo[iJetColl].Track_PV[pos.nTrack],
+                    JetInfo[iJetColl].Track_PVweight[pos.nTrack]);
 
-        if( pjet->hasTagInfo(svTagInfos_.c_str()) )
+        if(JetInfo[iJetColl].Track_PVweight[pos.nTrack]>0) { allKinematics.add(ptrack, JetInfo[iJetColl].Track_PVweight[pos.nTrack]); }
+      }
+
+      if ( jetDemand_[iJetColl].tracksSV )
+      {
+        if( svTagInfo )
         {
-          setTracksSV(ptrackRef, svTagInfo,
-                      JetInfo[iJetColl].Track_isfromSV[JetInfo[iJetColl].nTrack],
-                      JetInfo[iJetColl].Track_SV[JetInfo[iJetColl].nTrack],
-                      JetInfo[iJetColl].Track_SVweight[JetInfo[iJetColl].nTrack]);
+          setTracksSV(ptrackRef, jetTools.trackSVs,
+                      JetInfo[iJetColl].Track_isfromSV[pos.nTrack],
+                      JetInfo[iJetColl].Track_SV[pos.nTrack],
+                      JetInfo[iJetColl].Track_SVweight[pos.nTrack]);
         }
         else
         {
-          JetInfo[iJetColl].Track_isfromSV[JetInfo[iJetColl].nTrack] = 0;
-          JetInfo[iJetColl].Track_SV[JetInfo[iJetColl].nTrack] = -1;
-          JetInfo[iJetColl].Track_SVweight[JetInfo[iJetColl].nTrack] = 0.;
+          JetInfo[iJetColl].Track_isfromSV[pos.nTrack] = 0;
+          JetInfo[iJetColl].Track_SV[pos.nTrack] = -1;
+          JetInfo[iJetColl].Track_SVweight[pos.nTrack] = 0.;
         }
+      }
 
-        ++JetInfo[iJetColl].nTrack;
-      } //// end loop on tracks
-    }
+      ++pos.nTrack;
+    } //// end loop on tracks
+  }
 
-    JetInfo[iJetColl].Jet_nseltracks[JetInfo[iJetColl].nJet] = nseltracks;
+  JetInfo[iJetColl].Jet_nseltracks[pos.nJet] = nseltracks;
 
-    if ( runSubJets_ && iJetColl == 1 )
-      JetInfo[iJetColl].Jet_nsharedtracks[JetInfo[iJetColl].nJet] = nsharedtracks;
+  if ( runSubJets_ && iJetColl == 1 )
+    JetInfo[iJetColl].Jet_nsharedtracks[pos.nJet] = nsharedtracks;
 
-    JetInfo[iJetColl].Jet_nLastTrack[JetInfo[iJetColl].nJet]   = JetInfo[iJetColl].nTrack;
+  JetInfo[iJetColl].Jet_nLastTrack[pos.nJet]   = pos.nTrack;
 
-    if ( produceJetPFLeptonTree_ )
-    {
-      // PFMuon information
-      for (unsigned int leptIdx = 0; leptIdx < (pjet->hasTagInfo(softPFMuonTagInfos_.c_str()) ? softPFMuTagInfo->leptons() : 0); ++leptIdx) {
-
-        JetInfo[iJetColl].PFMuon_IdxJet[JetInfo[iJetColl].nPFMuon]    = JetInfo[iJetColl].nJet;
-        JetInfo[iJetColl].PFMuon_pt[JetInfo[iJetColl].nPFMuon]        = softPFMuTagInfo->lepton(leptIdx)->pt();
-        JetInfo[iJetColl].PFMuon_eta[JetInfo[iJetColl].nPFMuon]       = softPFMuTagInfo->lepton(leptIdx)->eta();
-        JetInfo[iJetColl].PFMuon_phi[JetInfo[iJetColl].nPFMuon]       = softPFMuTagInfo->lepton(leptIdx)->phi();
-        JetInfo[iJetColl].PFMuon_ptrel[JetInfo[iJetColl].nPFMuon]     = (softPFMuTagInfo->properties(leptIdx).ptRel);
-        JetInfo[iJetColl].PFMuon_ratio[JetInfo[iJetColl].nPFMuon]     = (softPFMuTagInfo->properties(leptIdx).ratio);
-        JetInfo[iJetColl].PFMuon_ratioRel[JetInfo[iJetColl].nPFMuon]  = (softPFMuTagInfo->properties(leptIdx).ratioRel);
-        JetInfo[iJetColl].PFMuon_deltaR[JetInfo[iJetColl].nPFMuon]    = (softPFMuTagInfo->properties(leptIdx).deltaR);
-        JetInfo[iJetColl].PFMuon_IP[JetInfo[iJetColl].nPFMuon]        = (softPFMuTagInfo->properties(leptIdx).sip3d);
-        JetInfo[iJetColl].PFMuon_IP2D[JetInfo[iJetColl].nPFMuon]      = (softPFMuTagInfo->properties(leptIdx).sip2d);
-
-        ++JetInfo[iJetColl].nPFMuon;
-      }
+  if ( produceJetPFLeptonTree_ )
+  {
+    // PFMuon information
+    for (unsigned int leptIdx = 0; leptIdx < (softPFMuTagInfo ? softPFMuTagInfo->leptons() : 0); ++leptIdx) {
+
+      JetInfo[iJetColl].PFMuon_IdxJet[pos.nPFMuon]    = pos.nJet;
+      JetInfo[iJetColl].PFMuon_pt[pos.nPFMuon]        = softPFMuTagInfo->lepton(leptIdx)->pt();
+      JetInfo[iJetColl].PFMuon_eta[pos.nPFMuon]       = softPFMuTagInfo->lepton(leptIdx)->eta();
+      JetInfo[iJetColl].PFMuon_phi[pos.nPFMuon]       = softPFMuTagInfo->lepton(leptIdx)->phi();
+      JetInfo[iJetColl].PFMuon_ptrel[pos.nPFMuon]     = (softPFMuTagInfo->properties(leptIdx).ptRel);
+      JetInfo[iJetColl].PFMuon_ratio[pos.nPFMuon]     = (softPFMuTagInfo->properties(leptIdx).ratio);
+      JetInfo[iJetColl].PFMuon_ratioRel[pos.nPFMuon]  = (softPFMuTagInfo->properties(leptIdx).ratioRel);
+      JetInfo[iJetColl].PFMuon_deltaR[pos.nPFMuon]    = (softPFMuTagInfo->properties(leptIdx).deltaR);
+      JetInfo[iJetColl].PFMuon_IP[pos.nPFMuon]        = (softPFMuTagInfo->properties(leptIdx).sip3d);
+      JetInfo[iJetColl].PFMuon_IP2D[pos.nPFMuon]      = (softPFMuTagInfo->properties(leptIdx).sip2d);
+
+      ++pos.nPFMuon;
+    }
 
-      // PFElectron information
-      for (unsigned int leptIdx = 0; leptIdx < (pjet->hasTagInfo(softPFElectronTagInfos_.c_str()) ? softPFElTagInfo->leptons() : 0); ++leptIdx) {
-
-        JetInfo[iJetColl].PFElectron_IdxJet[JetInfo[iJetColl].nPFElectron]    = JetInfo[iJetColl].nJet;
-        JetInfo[iJetColl].PFElectron_pt[JetInfo[iJetColl].nPFElectron]        = softPFElTagInfo->lepton(leptIdx)->pt();
-        JetInfo[iJetColl].PFElectron_eta[JetInfo[iJetColl].nPFElectron]       = softPFElTagInfo->lepton(leptIdx)->eta();
-        JetInfo[iJetColl].PFElectron_phi[JetInfo[iJetColl].nPFElectron]       = softPFElTagInfo->lepton(leptIdx)->phi();
-        JetInfo[iJetColl].PFElectron_ptrel[JetInfo[iJetColl].nPFElectron]     = (softPFElTagInfo->properties(leptIdx).ptRel);
-        JetInfo[iJetColl].PFElectron_ratio[JetInfo[iJetColl].nPFElectron]     = (softPFElTagInfo->properties(leptIdx).ratio);
-        JetInfo[iJetColl].PFElectron_ratioRel[JetInfo[iJetColl].nPFElectron]  = (softPFElTagInfo->properties(leptIdx).ratioRel);
-        JetInfo[iJetColl].PFElectron_deltaR[JetInfo[iJetColl].nPFElectron]    = (softPFElTagInfo->properties(leptIdx).deltaR);
-        JetInfo[iJetColl].PFElectron_IP[JetInfo[iJetColl].nPFElectron]        = (softPFElTagInfo->properties(leptIdx).sip3d);
-        JetInfo[iJetColl].PFElectron_IP2D[JetInfo[iJetColl].nPFElectron]      = (softPFElTagInfo->properties(leptIdx).sip2d);
-
-        ++JetInfo[iJetColl].nPFElectron;
-      }
+    // PFElectron information
+    for (unsigned int leptIdx = 0; leptIdx < (softPFElTagInfo ? softPFElTagInfo->leptons() : 0); ++leptIdx) {
+
+      JetInfo[iJetColl].PFElectron_IdxJet[pos.nPFElectron]    = pos.nJet;
+      JetInfo[iJetColl].PFElectron_pt[pos.nPFElectron]        = softPFElTagInfo->lepton(leptIdx)->pt();
+      JetInfo[iJetColl].PFElectron_eta[pos.nPFElectron]       = softPFElTagInfo->lepton(leptIdx)->eta();
+      JetInfo[iJetColl].PFElectron_phi[pos.nPFElectron]       = softPFElTagInfo->lepton(leptIdx)->phi();
+      JetInfo[iJetColl].PFElectron_ptrel[pos.nPFElectron]     = (softPFElTagInfo->properties(leptIdx).ptRel);
+      JetInfo[iJetColl].PFElectron_ratio[pos.nPFElectron]     = (softPFElTagInfo->properties(leptIdx).ratio);
+      JetInfo[iJetColl].PFElectron_ratioRel[pos.nPFElectron]  = (softPFElTagInfo->properties(leptIdx).ratioRel);
+      JetInfo[iJetColl].PFElectron_deltaR[pos.nPFElectron]    = (softPFElTagInfo->properties(leptIdx).deltaR);
+      JetInfo[iJetColl].PFElectron_IP[pos.nPFElectron]        = (softPFElTagInfo->properties(leptIdx).sip3d);
+      JetInfo[iJetColl].PFElectron_IP2D[pos.nPFElectron]      = (softPFElTagInfo->properties(leptIdx).sip2d);
+
+      ++pos.nPFElectron;
     }
+  }
 
-    // b-tagger discriminants
-    float Proba  = pjet->bDiscriminator(jetPBJetTags_.c_str());
-    float ProbaN = pjet->bDiscriminator(jetPNegBJetTags_.c_str());
-    float ProbaP = pjet->bDiscriminator(jetPPosBJetTags_.c_str());
-
-    float Bprob  = pjet->bDiscriminator(jetBPBJetTags_.c_str());
-    float BprobN = pjet->bDiscriminator(jetBPNegBJetTags_.c_str());
-    float BprobP = pjet->bDiscriminator(jetBPPosBJetTags_.c_str());
-
-    float Svtx    = pjet->bDiscriminator(simpleSVHighEffBJetTags_.c_str());
-    float SvtxN   = pjet->bDiscriminator(simpleSVNegHighEffBJetTags_.c_str());
-    float SvtxHP  = pjet->bDiscriminator(simpleSVHighPurBJetTags_.c_str());
-    float SvtxNHP = pjet->bDiscriminator(simpleSVNegHighPurBJetTags_.c_str());
-
-    float CombinedSvtx  = pjet->bDiscriminator(combinedSVBJetTags_.c_str());
-    float CombinedSvtxP = pjet->bDiscriminator(combinedSVPosBJetTags_.c_str());
-    float CombinedSvtxN = pjet->bDiscriminator(combinedSVNegBJetTags_.c_str());
-
-    float CombinedIVF     = pjet->bDiscriminator(combinedIVFSVBJetTags_.c_str());
-    float CombinedIVF_P   = pjet->bDiscriminator(combinedIVFSVPosBJetTags_.c_str());
-    float CombinedIVF_N   = pjet->bDiscriminator(combinedIVFSVNegBJetTags_.c_str());
-
-    float SoftM  = pjet->bDiscriminator(softPFMuonBJetTags_.c_str());
-    float SoftMN = pjet->bDiscriminator(softPFMuonNegBJetTags_.c_str());
-    float SoftMP = pjet->bDiscriminator(softPFMuonPosBJetTags_.c_str());
-
-    float SoftE  = pjet->bDiscriminator(softPFElectronBJetTags_.c_str());
-    float SoftEN = pjet->bDiscriminator(softPFElectronNegBJetTags_.c_str());
-    float SoftEP = pjet->bDiscriminator(softPFElectronPosBJetTags_.c_str());
-
-    // Jet information
-    JetInfo[iJetColl].Jet_ProbaN[JetInfo[iJetColl].nJet]   = ProbaN;
-    JetInfo[iJetColl].Jet_ProbaP[JetInfo[iJetColl].nJet]   = ProbaP;
-    JetInfo[iJetColl].Jet_Proba[JetInfo[iJetColl].nJet]    = Proba;
-    JetInfo[iJetColl].Jet_BprobN[JetInfo[iJetColl].nJet]   = BprobN;
-    JetInfo[iJetColl].Jet_BprobP[JetInfo[iJetColl].nJet]   = BprobP;
-    JetInfo[iJetColl].Jet_Bprob[JetInfo[iJetColl].nJet]    = Bprob;
-    JetInfo[iJetColl].Jet_SvxN[JetInfo[iJetColl].nJet]     = SvtxN;
-    JetInfo[iJetColl].Jet_Svx[JetInfo[iJetColl].nJet]      = Svtx;
-    JetInfo[iJetColl].Jet_SvxNHP[JetInfo[iJetColl].nJet]   = SvtxNHP;
-    JetInfo[iJetColl].Jet_SvxHP[JetInfo[iJetColl].nJet]    = SvtxHP;
-    JetInfo[iJetColl].Jet_CombSvxN[JetInfo[iJetColl].nJet] = CombinedSvtxN;
-    JetInfo[iJetColl].Jet_CombSvxP[JetInfo[iJetColl].nJet] = CombinedSvtxP;
-    JetInfo[iJetColl].Jet_CombSvx[JetInfo[iJetColl].nJet]  = CombinedSvtx;
-    JetInfo[iJetColl].Jet_CombIVF[JetInfo[iJetColl].nJet]   = CombinedIVF;
-    JetInfo[iJetColl].Jet_CombIVF_P[JetInfo[iJetColl].nJet] = CombinedIVF_P;
-    JetInfo[iJetColl].Jet_CombIVF_N[JetInfo[iJetColl].nJet] = CombinedIVF_N;
-    JetInfo[iJetColl].Jet_SoftMuN[JetInfo[iJetColl].nJet]  = SoftMN;
-    JetInfo[iJetColl].Jet_SoftMuP[JetInfo[iJetColl].nJet]  = SoftMP;
-    JetInfo[iJetColl].Jet_SoftMu[JetInfo[iJetColl].nJet]   = SoftM;
-    JetInfo[iJetColl].Jet_SoftElN[JetInfo[iJetColl].nJet]  = SoftEN;
-    JetInfo[iJetColl].Jet_SoftElP[JetInfo[iJetColl].nJet]  = SoftEP;
-    JetInfo[iJetColl].Jet_SoftEl[JetInfo[iJetColl].nJet]   = SoftE;
-
-    // TagInfo TaggingVariables
-    if ( storeTagVariables_ )
+  // b-tagger discriminants (only the stored ones, at the positions resolved in processJets)
+  const std::vector<size_t> & discriminators = jetDemand_[iJetColl].discriminators;
+  const std::vector<size_t> & discriminatorIndices = cache.discriminatorIndices[iJetColl];
+  const std::vector<std::pair<std::string, float> > & pairDiscri = pjet->getPairDiscri();
+  for(size_t i=0; i<discriminators.size(); ++i)
+  {
+    const std::string & label = discriminators_[discriminators[i]].label;
+    const size_t index = ( i < discriminatorIndices.size() ? discriminatorIndices[i] : size_t(-1) );
+    float & value = (*cache.buffers->discriminatorColumns[iJetColl][discriminators[i]])[pos.nJet];
+    if ( index < pairDiscri.size() && pairDiscri[index].first == label )
+      value = pairDiscri[index].second;
+    else
     {
-      reco::TaggingVariableList ipVars = ipTagInfo->taggingVariables();
-      reco::TaggingVariableList svVars = svTagInfo->taggingVariables();
-      int nTracks = ipTagInfo->selectedTracks().size();
-      int nSVs = svTagInfo->nVertices();
-
-      // per jet
-      JetInfo[iJetColl].TagVar_jetNTracks[JetInfo[iJetColl].nJet]                  = nTracks;
-      JetInfo[iJetColl].TagVar_jetNSecondaryVertices[JetInfo[iJetColl].nJet]       = nSVs;
-      //-------------
-      JetInfo[iJetColl].TagVar_chargedHadronEnergyFraction[JetInfo[iJetColl].nJet] = pjet->chargedHadronEnergyFraction();
-      JetInfo[iJetColl].TagVar_neutralHadronEnergyFraction[JetInfo[iJetColl].nJet] = pjet->neutralHadronEnergyFraction();
-      JetInfo[iJetColl].TagVar_photonEnergyFraction[JetInfo[iJetColl].nJet]        = pjet->photonEnergyFraction();
-      JetInfo[iJetColl].TagVar_electronEnergyFraction[JetInfo[iJetColl].nJet]      = pjet->electronEnergyFraction();
-      JetInfo[iJetColl].TagVar_muonEnergyFraction[JetInfo[iJetColl].nJet]          = pjet->muonEnergyFraction();
-      JetInfo[iJetColl].TagVar_chargedHadronMultiplicity[JetInfo[iJetColl].nJet]   = pjet->chargedHadronMultiplicity();
-      JetInfo[iJetColl].TagVar_neutralHadronMultiplicity[JetInfo[iJetColl].nJet]   = pjet->neutralHadronMultiplicity();
-      JetInfo[iJetColl].TagVar_photonMultiplicity[JetInfo[iJetColl].nJet]          = pjet->photonMultiplicity();
-      JetInfo[iJetColl].TagVar_electronMultiplicity[JetInfo[iJetColl].nJet]        = pjet->electronMultiplicity();
-      JetInfo[iJetColl].TagVar_muonMultiplicity[JetInfo[iJetColl].nJet]            = pjet->muonMultiplicity();
-
-      // per jet per track
-      JetInfo[iJetColl].Jet_nFirstTrkTagVar[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nTrkTagVar;
-
-      std::vector<float> tagValList = ipVars.getList(reco::btau::trackMomentum,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackMomentum[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackEta,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackEta[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackPhi,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackPhi[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackPtRel,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackPtRel[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackPPar,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackPPar[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackEtaRel,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackEtaRel[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackDeltaR,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackDeltaR[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackPtRatio,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackPtRatio[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackPParRatio,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackPParRatio[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackSip2dVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackSip2dVal[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackSip2dSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackSip2dSig[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackSip3dVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackSip3dVal[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackSip3dSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackSip3dSig[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackDecayLenVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackDecayLenVal[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackDecayLenSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackDecayLenSig[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackJetDistVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackJetDistVal[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackJetDistSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackJetDistSig[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackChi2,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackChi2[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackNTotalHits,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackNTotalHits[JetInfo[iJetColl].nTrkTagVar] );
-      tagValList = ipVars.getList(reco::btau::trackNPixelHits,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_trackNPixelHits[JetInfo[iJetColl].nTrkTagVar] );
-
-      JetInfo[iJetColl].nTrkTagVar += nTracks;
-      JetInfo[iJetColl].Jet_nLastTrkTagVar[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nTrkTagVar;
-
-      // per jet per secondary vertex
-      JetInfo[iJetColl].Jet_nFirstSVTagVar[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nSVTagVar;
-
-      for(int svIdx=0; svIdx < nSVs; ++svIdx)
-      {
-        JetInfo[iJetColl].TagVar_vertexMass[JetInfo[iJetColl].nSVTagVar + svIdx]    = svTagInfo->secondaryVertex(svIdx).p4().mass();
-        //JetInfo[iJetColl].TagVar_vertexNTracks[JetInfo[iJetColl].nSVTagVar + svIdx] = svTagInfo->secondaryVertex(svIdx).nTracks();
-      }
-      tagValList = svVars.getList(reco::btau::vertexJetDeltaR,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_vertexJetDeltaR[JetInfo[iJetColl].nSVTagVar] );
-      tagValList = svVars.getList(reco::btau::flightDistance2dVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_flightDistance2dVal[JetInfo[iJetColl].nSVTagVar] );
-      tagValList = svVars.getList(reco::btau::flightDistance2dSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_flightDistance2dSig[JetInfo[iJetColl].nSVTagVar] );
-      tagValList = svVars.getList(reco::btau::flightDistance3dVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_flightDistance3dVal[JetInfo[iJetColl].nSVTagVar] );
-      tagValList = svVars.getList(reco::btau::flightDistance3dSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVar_flightDistance3dSig[JetInfo[iJetColl].nSVTagVar] );
-
-      JetInfo[iJetColl].nSVTagVar += nSVs;
-      JetInfo[iJetColl].Jet_nLastSVTagVar[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nSVTagVar;
+      value = pjet->bDiscriminator(label);
+      // (discriminators missing from the first jet are always looked up by label)
+      if ( index != size_t(-1) ) cache.discriminatorLayoutChanged[iJetColl] = true;
     }
+  }
 
-    // CSV TaggingVariables
-    if ( storeCSVTagVariables_ )
+  // TagInfo TaggingVariables
+  if ( storeTagVariables_ )
+  {
+    reco::TaggingVariableList ipVars = ipTagInfo->taggingVariables();
+    reco::TaggingVariableList svVars = svTagInfo->taggingVariables();
+    int nTracks = ipTagInfo->selectedTracks().size();
+    int nSVs = svTagInfo->nVertices();
+
+    // per jet
+    JetInfo[iJetColl].TagVar_jetNTracks[pos.nJet]                  = nTracks;
+    JetInfo[iJetColl].TagVar_jetNSecondaryVertices[pos.nJet]       = nSVs;
+    //-------------
+    JetInfo[iJetColl].TagVar_chargedHadronEnergyFraction[pos.nJet] = pjet->chargedHadronEnergyFraction();
+    JetInfo[iJetColl].TagVar_neutralHadronEnergyFraction[pos.nJet] = pjet->neutralHadronEnergyFraction();
+    JetInfo[iJetColl].TagVar_photonEnergyFraction[pos.nJet]        = pjet->photonEnergyFraction();
+    JetInfo[iJetColl].TagVar_electronEnergyFraction[pos.nJet]      = pjet->electronEnergyFraction();
+    JetInfo[iJetColl].TagVar_muonEnergyFraction[pos.nJet]          = pjet->muonEnergyFraction();
+    JetInfo[iJetColl].TagVar_chargedHadronMultiplicity[pos.nJet]   = pjet->chargedHadronMultiplicity();
+    JetInfo[iJetColl].TagVar_neutralHadronMultiplicity[pos.nJet]   = pjet->neutralHadronMultiplicity();
+    JetInfo[iJetColl].TagVar_photonMultiplicity[pos.nJet]          = pjet->photonMultiplicity();
+    JetInfo[iJetColl].TagVar_electronMultiplicity[pos.nJet]        = pjet->electronMultiplicity();
+    JetInfo[iJetColl].TagVar_muonMultiplicity[pos.nJet]            = pjet->muonMultiplicity();
+
+    // per jet per track
+    JetInfo[iJetColl].Jet_nFirstTrkTagVar[pos.nJet] = pos.nTrkTagVar;
+
+    ipTagVars_.extract(ipVars, JetInfo[iJetColl], pos.nJet, &pos.nTrkTagVar, &nTracks);
+
+    pos.nTrkTagVar += nTracks;
+    JetInfo[iJetColl].Jet_nLastTrkTagVar[pos.nJet] = pos.nTrkTagVar;
+
+    // per jet per secondary vertex
+    JetInfo[iJetColl].Jet_nFirstSVTagVar[pos.nJet] = pos.nSVTagVar;
+
+    for(int svIdx=0; svIdx < nSVs; ++svIdx)
     {
-      std::vector<const reco::BaseTagInfo*>  baseTagInfos;
-      JetTagComputer::TagInfoHelper helper(baseTagInfos);
-      baseTagInfos.push_back( ipTagInfo );
-      baseTagInfos.push_back( svTagInfo );
-      // TaggingVariables
-      reco::TaggingVariableList vars = computer->taggingVariables(helper);
-
-      // per jet
-      JetInfo[iJetColl].TagVarCSV_trackJetPt[JetInfo[iJetColl].nJet]                  = ( vars.checkTag(reco::btau::trackJetPt) ? vars.get(reco::btau::trackJetPt) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_vertexCategory[JetInfo[iJetColl].nJet]              = ( vars.checkTag(reco::btau::vertexCategory) ? vars.get(reco::btau::vertexCategory) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_jetNSecondaryVertices[JetInfo[iJetColl].nJet]       = ( vars.checkTag(reco::btau::jetNSecondaryVertices) ? vars.get(reco::btau::jetNSecondaryVertices) : 0 );
-      JetInfo[iJetColl].TagVarCSV_trackSumJetEtRatio[JetInfo[iJetColl].nJet]          = ( vars.checkTag(reco::btau::trackSumJetEtRatio) ? vars.get(reco::btau::trackSumJetEtRatio) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_trackSumJetDeltaR[JetInfo[iJetColl].nJet]           = ( vars.checkTag(reco::btau::trackSumJetDeltaR) ? vars.get(reco::btau::trackSumJetDeltaR) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_trackSip2dValAboveCharm[JetInfo[iJetColl].nJet]     = ( vars.checkTag(reco::btau::trackSip2dValAboveCharm) ? vars.get(reco::btau::trackSip2dValAboveCharm) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_trackSip2dSigAboveCharm[JetInfo[iJetColl].nJet]     = ( vars.checkTag(reco::btau::trackSip2dSigAboveCharm) ? vars.get(reco::btau::trackSip2dSigAboveCharm) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_trackSip3dValAboveCharm[JetInfo[iJetColl].nJet]     = ( vars.checkTag(reco::btau::trackSip3dValAboveCharm) ? vars.get(reco::btau::trackSip3dValAboveCharm) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_trackSip3dSigAboveCharm[JetInfo[iJetColl].nJet]     = ( vars.checkTag(reco::btau::trackSip3dSigAboveCharm) ? vars.get(reco::btau::trackSip3dSigAboveCharm) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_vertexMass[JetInfo[iJetColl].nJet]                  = ( vars.checkTag(reco::btau::vertexMass) ? vars.get(reco::btau::vertexMass) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_vertexNTracks[JetInfo[iJetColl].nJet]               = ( vars.checkTag(reco::btau::vertexNTracks) ? vars.get(reco::btau::vertexNTracks) : 0 );
-      JetInfo[iJetColl].TagVarCSV_vertexEnergyRatio[JetInfo[iJetColl].nJet]           = ( vars.checkTag(reco::btau::vertexEnergyRatio) ? vars.get(reco::btau::vertexEnergyRatio) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_vertexJetDeltaR[JetInfo[iJetColl].nJet]             = ( vars.checkTag(reco::btau::vertexJetDeltaR) ? vars.get(reco::btau::vertexJetDeltaR) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_flightDistance2dVal[JetInfo[iJetColl].nJet]         = ( vars.checkTag(reco::btau::flightDistance2dVal) ? vars.get(reco::btau::flightDistance2dVal) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_flightDistance2dSig[JetInfo[iJetColl].nJet]         = ( vars.checkTag(reco::btau::flightDistance2dSig) ? vars.get(reco::btau::flightDistance2dSig) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_flightDistance3dVal[JetInfo[iJetColl].nJet]         = ( vars.checkTag(reco::btau::flightDistance3dVal) ? vars.get(reco::btau::flightDistance3dVal) : -9999 );
-      JetInfo[iJetColl].TagVarCSV_flightDistance3dSig[JetInfo[iJetColl].nJet]         = ( vars.checkTag(reco::btau::flightDistance3dSig) ? vars.get(reco::btau::flightDistance3dSig) : -9999 );
-
-      // per jet per track
-      JetInfo[iJetColl].Jet_nFirstTrkTagVarCSV[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nTrkTagVarCSV;
-      std::vector<float> tagValList = vars.getList(reco::btau::trackSip2dSig,false);
-      JetInfo[iJetColl].TagVarCSV_jetNTracks[JetInfo[iJetColl].nJet] = tagValList.size();
-
-      tagValList = vars.getList(reco::btau::trackMomentum,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackMomentum[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackEta,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackEta[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackPhi,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackPhi[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackPtRel,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackPtRel[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackPPar,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackPPar[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackDeltaR,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackDeltaR[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackPtRatio,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackPtRatio[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackPParRatio,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackPParRatio[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackSip2dVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackSip2dVal[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackSip2dSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackSip2dSig[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackSip3dVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackSip3dVal[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackSip3dSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackSip3dSig[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackDecayLenVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackDecayLenVal[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackDecayLenSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackDecayLenSig[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackJetDistVal,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackJetDistVal[JetInfo[iJetColl].nTrkTagVarCSV] );
-      tagValList = vars.getList(reco::btau::trackJetDistSig,false);
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackJetDistSig[JetInfo[iJetColl].nTrkTagVarCSV] );
-
-      JetInfo[iJetColl].nTrkTagVarCSV += JetInfo[iJetColl].TagVarCSV_jetNTracks[JetInfo[iJetColl].nJet];
-      JetInfo[iJetColl].Jet_nLastTrkTagVarCSV[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nTrkTagVarCSV;
-      //---------------------------
-      JetInfo[iJetColl].Jet_nFirstTrkEtaRelTagVarCSV[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nTrkEtaRelTagVarCSV;
-      tagValList = vars.getList(reco::btau::trackEtaRel,false);
-      JetInfo[iJetColl].TagVarCSV_jetNTracksEtaRel[JetInfo[iJetColl].nJet] = tagValList.size();
-
-      if(tagValList.size()>0) std::copy( tagValList.begin(), tagValList.end(), &JetInfo[iJetColl].TagVarCSV_trackEtaRel[JetInfo[iJetColl].nTrkEtaRelTagVarCSV] );
-
-      JetInfo[iJetColl].nTrkEtaRelTagVarCSV += JetInfo[iJetColl].TagVarCSV_jetNTracksEtaRel[JetInfo[iJetColl].nJet];
-      JetInfo[iJetColl].Jet_nLastTrkEtaRelTagVarCSV[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nTrkEtaRelTagVarCSV;
+      JetInfo[iJetColl].TagVar_vertexMass[pos.nSVTagVar + svIdx]    = svTagInfo->secondaryVertex(svIdx).p4().mass();
+      //JetInfo[iJetColl].TagVar_vertexNTracks[pos.nSVTagVar + svIdx] = svTagInfo->secondaryVertex(svIdx).nTracks();
     }
+    svTagVars_.extract(svVars, JetInfo[iJetColl], pos.nJet, &pos.nSVTagVar, &nSVs);
 
-    //*****************************************************************
-    // get track histories associated to sec. vertex (for simple SV)
-    //*****************************************************************
-    JetInfo[iJetColl].Jet_nFirstSV[JetInfo[iJetColl].nJet]  = JetInfo[iJetColl].nSV;
-    JetInfo[iJetColl].Jet_SV_multi[JetInfo[iJetColl].nJet]  = svTagInfo->nVertices();
+    pos.nSVTagVar += nSVs;
+    JetInfo[iJetColl].Jet_nLastSVTagVar[pos.nJet] = pos.nSVTagVar;
+  }
 
-    // if secondary vertices present
-    for (int vtx = 0; vtx < JetInfo[iJetColl].Jet_SV_multi[JetInfo[iJetColl].nJet]; ++vtx )
-    {
+  // CSV TaggingVariables
+  if ( storeCSVTagVariables_ && jetDemand_[iJetColl].csvTagVariables )
+  {
+    // TaggingVariables (computed when the jet was prepared)
+    const reco::TaggingVariableList & vars = rec.csvVars;
+
+    // per jet and per jet per track, in a single pass over the list
+    const int first[2]  = { pos.nTrkTagVarCSV, pos.nTrkEtaRelTagVarCSV };
+    const int length[2] = { rec.counts.nTrkTagVarCSV, rec.counts.nTrkEtaRelTagVarCSV };
+    csvTagVars_.extract(vars, JetInfo[iJetColl], pos.nJet, first, length);
+
+    JetInfo[iJetColl].TagVarCSV_jetNTracks[pos.nJet] = rec.counts.nTrkTagVarCSV;
+    JetInfo[iJetColl].Jet_nFirstTrkTagVarCSV[pos.nJet] = pos.nTrkTagVarCSV;
+    pos.nTrkTagVarCSV += rec.counts.nTrkTagVarCSV;
+    JetInfo[iJetColl].Jet_nLastTrkTagVarCSV[pos.nJet] = pos.nTrkTagVarCSV;
+    //---------------------------
+    JetInfo[iJetColl].TagVarCSV_jetNTracksEtaRel[pos.nJet] = rec.counts.nTrkEtaRelTagVarCSV;
+    JetInfo[iJetColl].Jet_nFirstTrkEtaRelTagVarCSV[pos.nJet] = pos.nTrkEtaRelTagVarCSV;
+    pos.nTrkEtaRelTagVarCSV += rec.counts.nTrkEtaRelTagVarCSV;
+    JetInfo[iJetColl].Jet_nLastTrkEtaRelTagVarCSV[pos.nJet] = pos.nTrkEtaRelTagVarCSV;
+  }
+
+  //*****************************************************************
+  // get track histories associated to sec. vertex (for simple SV)
+  //*****************************************************************
+  JetInfo[iJetColl].Jet_nFirstSV[pos.nJet]  = pos.nSV;
+  JetInfo[iJetColl].Jet_SV_multi[pos.nJet]  = svTagInfo->nVertices();
+
+  // if secondary vertices present
+  for (int vtx = 0; vtx < JetInfo[iJetColl].Jet_SV_multi[pos.nJet]; ++vtx )
+  {
 
-      JetInfo[iJetColl].SV_x[JetInfo[iJetColl].nSV]    = position(svTagInfo->secondaryVertex(vtx)).x();
-      JetInfo[iJetColl].SV_y[JetInfo[iJetColl].nSV]    = position(svTagInfo->secondaryVertex(vtx)).y();
-      JetInfo[iJetColl].SV_z[JetInfo[iJetColl].nSV]    = position(svTagInfo->secondaryVertex(vtx)).z();
-      JetInfo[iJetColl].SV_ex[JetInfo[iJetColl].nSV]   = xError(svTagInfo->secondaryVertex(vtx));
-      JetInfo[iJetColl].SV_ey[JetInfo[iJetColl].nSV]   = yError(svTagInfo->secondaryVertex(vtx));
-      JetInfo[iJetColl].SV_ez[JetInfo[iJetColl].nSV]   = zError(svTagInfo->secondaryVertex(vtx));
-      JetInfo[iJetColl].SV_chi2[JetInfo[iJetColl].nSV] = chi2(svTagInfo->secondaryVertex(vtx));
-      JetInfo[iJetColl].SV_ndf[JetInfo[iJetColl].nSV]  = ndof(svTagInfo->secondaryVertex(vtx));
+    JetInfo[iJetColl].SV_x[pos.nSV]    = position(svTagInfo->secondaryVertex(vtx)).x();
+    JetInfo[iJetColl].SV_y[pos.nSV]    = position(svTagInfo->secondaryVertex(vtx)).y();
+    JetInfo[iJetColl].SV_z[pos.nSV]    = position(svTagInfo->secondaryVertex(vtx)).z();
+    JetInfo[iJetColl].SV_ex[pos.nSV]   = xError(svTagInfo->secondaryVertex(vtx));
+    JetInfo[iJetColl].SV_ey[pos.nSV]   = yError(svTagInfo->secondaryVertex(vtx));
+    JetInfo[iJetColl].SV_ez[pos.nSV]   = zError(svTagInfo->secondaryVertex(vtx));
+    JetInfo[iJetColl].SV_chi2[pos.nSV] = chi2(svTagInfo->secondaryVertex(vtx));
+    JetInfo[iJetColl].SV_ndf[pos.nSV]  = ndof(svTagInfo->secondaryVertex(vtx));
 
-      JetInfo[iJetColl].SV_flight[JetInfo[iJetColl].nSV]      = svTagInfo->flightDistance(vtx).value();
-      JetInfo[iJetColl].SV_flightErr[JetInfo[iJetColl].nSV]   = svTagInfo->flightDistance(vtx).error();
-      JetInfo[iJetColl].SV_flight2D[JetInfo[iJetColl].nSV]    = svTagInfo->flightDistance(vtx, true).value();
-      JetInfo[iJetColl].SV_flight2DErr[JetInfo[iJetColl].nSV] = svTagInfo->flightDistance(vtx, true).error();
-      JetInfo[iJetColl].SV_nTrk[JetInfo[iJetColl].nSV]        = nTracks(svTagInfo->secondaryVertex(vtx));
+    JetInfo[iJetColl].SV_flight[pos.nSV]      = svTagInfo->flightDistance(vtx).value();
+    JetInfo[iJetColl].SV_flightErr[pos.nSV]   = svTagInfo->flightDistance(vtx).error();
+    JetInfo[iJetColl].SV_flight2D[pos.nSV]    = svTagInfo->flightDistance(vtx, true).value();
+    JetInfo[iJetColl].SV_flight2DErr[pos.nSV] = svTagInfo->flightDistance(vtx, true).error();
+    JetInfo[iJetColl].SV_nTrk[pos.nSV]        = nTracks(svTagInfo->secondaryVertex(vtx));
 
 
-      const Vertex &vertex = svTagInfo->secondaryVertex(vtx);
+    const Vertex &vertex = svTagInfo->secondaryVertex(vtx);
 
-      JetInfo[iJetColl].SV_vtx_pt[JetInfo[iJetColl].nSV]  = vertex.p4().pt();
-      JetInfo[iJetColl].SV_vtx_eta[JetInfo[iJetColl].nSV] = vertex.p4().eta();
-      JetInfo[iJetColl].SV_vtx_phi[JetInfo[iJetColl].nSV] = vertex.p4().phi();
-      JetInfo[iJetColl].SV_mass[JetInfo[iJetColl].nSV]    = vertex.p4().mass();
+    JetInfo[iJetColl].SV_vtx_pt[pos.nSV]  = vertex.p4().pt();
+    JetInfo[iJetColl].SV_vtx_eta[pos.nSV] = vertex.p4().eta();
+    JetInfo[iJetColl].SV_vtx_phi[pos.nSV] = vertex.p4().phi();
+    JetInfo[iJetColl].SV_mass[pos.nSV]    = vertex.p4().mass();
 
-      Int_t totcharge=0;
-      reco::TrackKinematics vertexKinematics;
+    Int_t totcharge=0;
+    reco::TrackKinematics vertexKinematics;
 
-      // get the vertex kinematics and charge
-      vertexKinematicsAndChange(vertex, vertexKinematics, totcharge);
+    // get the vertex kinematics and charge
+    vertexKinematicsAndChange(vertex, vertexKinematics, totcharge);
 
-      // total charge at the secondary vertex
-      JetInfo[iJetColl].SV_totCharge[JetInfo[iJetColl].nSV]=totcharge;
+    // total charge at the secondary vertex
+    JetInfo[iJetColl].SV_totCharge[pos.nSV]=totcharge;
 	
 	
 
-      math::XYZTLorentzVector vertexSum = vertexKinematics.weightedVectorSum();
-      edm::RefToBase<reco::Jet> jet = ipTagInfo->jet();
-      math::XYZVector jetDir = jet->momentum().Unit();
-      GlobalVector flightDir = svTagInfo->flightDirection(vtx);
+    math::XYZTLorentzVector vertexSum = vertexKinematics.weightedVectorSum();
+    edm::RefToBase<reco::Jet> jet = ipTagInfo->jet();
+    math::XYZVector jetDir = jet->momentum().Unit();
+    GlobalVector flightDir = svTagInfo->flightDirection(vtx);
 
-      JetInfo[iJetColl].SV_deltaR_jet[JetInfo[iJetColl].nSV]     = ( reco::deltaR(flightDir, jetDir) );
-      JetInfo[iJetColl].SV_deltaR_sum_jet[JetInfo[iJetColl].nSV] = ( reco::deltaR(vertexSum, jetDir) );
-      JetInfo[iJetColl].SV_deltaR_sum_dir[JetInfo[iJetColl].nSV] = ( reco::deltaR(vertexSum, flightDir) );
+    JetInfo[iJetColl].SV_deltaR_jet[pos.nSV]     = ( reco::deltaR(flightDir, jetDir) );
+    JetInfo[iJetColl].SV_deltaR_sum_jet[pos.nSV] = ( reco::deltaR(vertexSum, jetDir) );
+    JetInfo[iJetColl].SV_deltaR_sum_dir[pos.nSV] = ( reco::deltaR(vertexSum, flightDir) );
 
-      Line::PositionType pos(GlobalPoint(position(vertex).x(),position(vertex).y(),position(vertex).z()));
-      Line trackline(pos,flightDir);
+    if ( jetDemand_[iJetColl].svJetAxisDistance )
+    {
+      Line::PositionType svPos(GlobalPoint(position(vertex).x(),position(vertex).y(),position(vertex).z()));
+      Line trackline(svPos,flightDir);
       // get the Jet  line
       Line::PositionType pos2(GlobalPoint(pv->x(),pv->y(),pv->z()));
       Line::DirectionType dir2(GlobalVector(jetDir.x(),jetDir.y(),jetDir.z()));
       Line jetline(pos2,dir2);
       // now compute the distance between the two lines
-      JetInfo[iJetColl].SV_vtxDistJetAxis[JetInfo[iJetColl].nSV] = (jetline.distance(trackline)).mag();
+      JetInfo[iJetColl].SV_vtxDistJetAxis[pos.nSV] = (jetline.distance(trackline)).mag();
+    }
 
 
-      math::XYZTLorentzVector allSum =  allKinematics.weightedVectorSum() ; //allKinematics.vectorSum()
-      JetInfo[iJetColl].SV_EnergyRatio[JetInfo[iJetColl].nSV]= vertexSum.E() / allSum.E();
+    math::XYZTLorentzVector allSum =  allKinematics.weightedVectorSum() ; //allKinematics.vectorSum()
+    JetInfo[iJetColl].SV_EnergyRatio[pos.nSV]= vertexSum.E() / allSum.E();
 	
 
-      JetInfo[iJetColl].SV_dir_x[JetInfo[iJetColl].nSV]= flightDir.x();
-      JetInfo[iJetColl].SV_dir_y[JetInfo[iJetColl].nSV]= flightDir.y();		
-      JetInfo[iJetColl].SV_dir_z[JetInfo[iJetColl].nSV]= flightDir.z(); 
-
+    JetInfo[iJetColl].SV_dir_x[pos.nSV]= flightDir.x();
+    JetInfo[iJetColl].SV_dir_y[pos.nSV]= flightDir.y();		
+    JetInfo[iJetColl].SV_dir_z[pos.nSV]= flightDir.z(); 
 
 
 
-      ++JetInfo[iJetColl].nSV;
 
-    } //// if secondary vertices present
-    JetInfo[iJetColl].Jet_nLastSV[JetInfo[iJetColl].nJet] = JetInfo[iJetColl].nSV;
+    ++pos.nSV;
 
-    ++JetInfo[iJetColl].nJet;
-  } // end loop on jet
-
-  return;
-} // BTagAnalyzerLiteT:: processJets
+  } //// if secondary vertices present
+  JetInfo[iJetColl].Jet_nLastSV[pos.nJet] = pos.nSV;
+}
 
 
 template<typename IPTI,typename VTX>
-void BTagAnalyzerLiteT<IPTI,VTX>::setTracksPVBase(const reco::TrackRef & trackRef, const edm::Handle<reco::VertexCollection> & pvHandle, int & iPV, float & PVweight)
+void BTagAnalyzerLiteT<IPTI,VTX>::setTracksPVBase(const reco::TrackRef & trackRef, const BTagAnalyzerLiteTrackVertexMap & trackPVs, int & iPV, float & PVweight) const
 {
-  iPV = -1;
-  PVweight = 0.;
-
-  const reco::TrackBaseRef trackBaseRef( trackRef );
-
-  typedef reco::VertexCollection::const_iterator IV;
-  typedef reco::Vertex::trackRef_iterator IT;
-
-  for(IV iv=pvHandle->begin(); iv!=pvHandle->end(); ++iv)
-  {
-    const reco::Vertex & vtx = *iv;
-    // loop over tracks in vertices
-    for(IT it=vtx.tracks_begin(); it!=vtx.tracks_end(); ++it)
-    {
-      const reco::TrackBaseRef & baseRef = *it;
-      // one of the tracks in the vertex is the same as the track considered in the function
-      if( baseRef == trackBaseRef )
-      {
-        float w = vtx.trackWeight(baseRef);
-        // select the vertex for which the track has the highest weight
-        if( w > PVweight )
-        {
-          PVweight = w;
-          iPV = ( iv - pvHandle->begin() );
-          break;
-        }
-      }
-    }
-  }
+  trackPVs.find(trackRef, iPV, PVweight);
 }
 
 
@@ -1387,11 +2403,56 @@ void BTagAnalyzerLiteT<IPTI,VTX>::beginJob() {
 // ------------ method called once each job just after ending the event loop  ------------
 template<typename IPTI,typename VTX>
 void BTagAnalyzerLiteT<IPTI,VTX>::endJob() {
+  // write the entries still queued for the background writer
+  if ( treeWriter_ )
+  {
+    treeWriter_->stop();
+    edm::LogInfo("AsyncTreeFilling") << "Background tree filling used " << treeWriter_->nAllocated() << " additional buffer set(s)";
+  }
+
+  std::unique_lock<std::mutex> lock(outputFileMutex());
+
+  // link the split trees to the event tree: all trees have one entry per event, the index on (Run,Evt)
+  // also allows matching them after the entries of one of them were filtered or reordered
+  for(std::vector<TTree*>::const_iterator it = linkedTrees_.begin(); it != linkedTrees_.end(); ++it)
+  {
+    (*it)->BuildIndex("Run","Evt");
+    smalltree->AddFriend(*it);
+  }
+
+  // compression ratio of each I/O group (the pending baskets are written first)
+  smalltree->FlushBaskets();
+  for(std::vector<TTree*>::const_iterator it = linkedTrees_.begin(); it != linkedTrees_.end(); ++it) (*it)->FlushBaskets();
+  if ( flattree ) flattree->FlushBaskets();
+  for(std::vector<std::pair<TBranch*,size_t> >::const_iterator it = ioBranches_.begin(); it != ioBranches_.end(); ++it)
+  {
+    ioGroups_[it->second].totBytes += it->first->GetTotBytes();
+    ioGroups_[it->second].zipBytes += it->first->GetZipBytes();
+  }
+  lock.unlock();
+
+  edm::LogInfo ioLog("OutputCompression");
+  for(std::vector<BTagAnalyzerLiteIOGroup>::const_iterator it = ioGroups_.begin(); it != ioGroups_.end(); ++it)
+    ioLog << it->name << ": " << it->totBytes << " bytes, " << it->zipBytes << " compressed"
+          << " (ratio " << ( it->zipBytes > 0 ? double(it->totBytes)/it->zipBytes : 0. ) << ")\n";
+
+  // largest number of entries the variable-length columns had to hold
+  std::unique_ptr<Buffers> names(makeBuffers());
+  edm::LogInfo log("BranchHighWaterMarks");
+  std::vector<std::pair<std::string,const int*> > counters = names->EventInfo.Counters();
+  for(size_t i=0; i<eventHighWaterMarks_.size(); ++i)
+    log << counters[i].first << ": " << eventHighWaterMarks_[i] << "\n";
+  for(UInt_t iJetColl=0; iJetColl<(runSubJets_ ? 2 : 1); ++iJetColl)
+  {
+    counters = names->JetInfo[iJetColl].Counters();
+    for(size_t i=0; i<jetHighWaterMarks_[iJetColl].size(); ++i)
+      log << (iJetColl==0 ? (runSubJets_ ? "JetInfo." : "") : "FatJetInfo.") << counters[i].first << ": " << jetHighWaterMarks_[iJetColl][i] << "\n";
+  }
 }
 
 
 template<typename IPTI,typename VTX>
-bool BTagAnalyzerLiteT<IPTI,VTX>::isHardProcess(const int status)
+bool BTagAnalyzerLiteT<IPTI,VTX>::isHardProcess(const int status) const
 {
   // if Pythia8
   if( hadronizerType_ & (1 << 1) )
@@ -1408,70 +2469,44 @@ bool BTagAnalyzerLiteT<IPTI,VTX>::isHardProcess(const int status)
   return false;
 }
 
-// -------------------------------------------------------------------------
-// NameCompatible
-// -------------------------------------------------------------------------
-template<typename IPTI,typename VTX>
-bool BTagAnalyzerLiteT<IPTI,VTX>::NameCompatible(const std::string& pattern, const std::string& name)
-{
-  const boost::regex regexp(edm::glob2reg(pattern));
-
-  return boost::regex_match(name,regexp);
-}
-
 // ------------ method that matches groomed and original jets based on minimum dR ------------
 template<typename IPTI,typename VTX>
 void BTagAnalyzerLiteT<IPTI,VTX>::matchGroomedJets(const edm::Handle<PatJetCollection>& jets,
                                                    const edm::Handle<PatJetCollection>& groomedJets,
-                                                   std::vector<int>& matchedIndices)
+                                                   std::vector<int>& matchedIndices) const
 {
-   std::vector<bool> jetLocks(jets->size(),false);
-   std::vector<int>  jetIndices;
+   // each groomed jet takes the closest (in rapidity and phi) original jet not matched before
+   DeltaRMatcher matcher(1.);
+   for(size_t j=0; j<jets->size(); ++j)
+     matcher.Add( jets->at(j).rapidity(), jets->at(j).phi() );
+
+   matchedIndices.assign(jets->size(), -1);
+   bool matchingFailed = false;
 
    for(size_t gj=0; gj<groomedJets->size(); ++gj)
    {
-     double matchedDR2 = 1e9;
-     int matchedIdx = -1;
-
-     for(size_t j=0; j<jets->size(); ++j)
-     {
-       if( jetLocks.at(j) ) continue; // skip jets that have already been matched
-
-       double tempDR2 = reco::deltaR2( jets->at(j).rapidity(), jets->at(j).phi(), groomedJets->at(gj).rapidity(), groomedJets->at(gj).phi() );
-       if( tempDR2 < matchedDR2 )
-       {
-         matchedDR2 = tempDR2;
-         matchedIdx = j;
-       }
-     }
-
-     if( matchedIdx>=0 ) jetLocks.at(matchedIdx) = true;
-     jetIndices.push_back(matchedIdx);
+     int matchedIdx = matcher.Match( groomedJets->at(gj).rapidity(), groomedJets->at(gj).phi() );
+
+     if( matchedIdx>=0 ) matchedIndices.at(matchedIdx) = gj;
+     else matchingFailed = true;
    }
 
-   if( std::find( jetIndices.begin(), jetIndices.end(), -1 ) != jetIndices.end() )
+   if( matchingFailed )
      edm::LogError("JetMatchingFailed") << "Matching groomed to original jets failed. Please check that the two jet collections belong to each other.";
-
-   for(size_t j=0; j<jets->size(); ++j)
-   {
-     std::vector<int>::iterator matchedIndex = std::find( jetIndices.begin(), jetIndices.end(), j );
-
-     matchedIndices.push_back( matchedIndex != jetIndices.end() ? std::distance(jetIndices.begin(),matchedIndex) : -1 );
-   }
 }
 
 // -------------- template specializations --------------------
 // -------------- toIPTagInfo ----------------
 template<>
 const BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::IPTagInfo *
-BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::toIPTagInfo(const pat::Jet & jet, const std::string & tagInfos)
+BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::toIPTagInfo(const pat::Jet & jet, const std::string & tagInfos) const
 {
   return jet.tagInfoTrackIP(tagInfos.c_str());
 }
 
 template<>
 const BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::IPTagInfo *
-BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::toIPTagInfo(const pat::Jet & jet, const std::string & tagInfos)
+BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::toIPTagInfo(const pat::Jet & jet, const std::string & tagInfos) const
 {
   return jet.tagInfoCandIP(tagInfos.c_str());
 }
@@ -1479,27 +2514,37 @@ BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::toIPTa
 // -------------- toSVTagInfo ----------------
 template<>
 const BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::SVTagInfo *
-BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::toSVTagInfo(const pat::Jet & jet, const std::string & tagInfos)
+BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::toSVTagInfo(const pat::Jet & jet, const std::string & tagInfos) const
 {
   return jet.tagInfoSecondaryVertex(tagInfos.c_str());
 }
 
 template<>
 const BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::SVTagInfo *
-BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::toSVTagInfo(const pat::Jet & jet, const std::string & tagInfos)
+BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::toSVTagInfo(const pat::Jet & jet, const std::string & tagInfos) const
 {
   return jet.tagInfoCandSecondaryVertex(tagInfos.c_str());
 }
 
+// -------------- resolveTagInfos ----------------
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::resolveTagInfos(const pat::Jet & jet, JetTagInfos & tagInfos) const
+{
+  tagInfos.ip       = toIPTagInfo(jet,ipTagInfos_);
+  tagInfos.sv       = toSVTagInfo(jet,svTagInfos_);
+  tagInfos.softPFMu = jet.tagInfoCandSoftLepton(softPFMuonTagInfos_);
+  tagInfos.softPFEl = jet.tagInfoCandSoftLepton(softPFElectronTagInfos_);
+}
+
 // -------------- setTracksPV ----------------
 template<>
-void BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::setTracksPV(const TrackRef & trackRef, const edm::Handle<reco::VertexCollection> & pvHandle, int & iPV, float & PVweight)
+void BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::setTracksPV(const TrackRef & trackRef, const BTagAnalyzerLiteTrackVertexMap & trackPVs, int & iPV, float & PVweight) const
 {
-  setTracksPVBase(trackRef, pvHandle, iPV, PVweight);
+  setTracksPVBase(trackRef, trackPVs, iPV, PVweight);
 }
 
 template<>
-void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::setTracksPV(const TrackRef & trackRef, const edm::Handle<reco::VertexCollection> & pvHandle, int & iPV, float & PVweight)
+void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::setTracksPV(const TrackRef & trackRef, const BTagAnalyzerLiteTrackVertexMap & trackPVs, int & iPV, float & PVweight) const
 {
   iPV = -1;
   PVweight = 0.;
@@ -1518,80 +2563,21 @@ void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::s
   {
     const reco::PFCandidate * pfcand = dynamic_cast<const reco::PFCandidate *>(trackRef.get());
 
-    setTracksPVBase(pfcand->trackRef(), pvHandle, iPV, PVweight);
+    setTracksPVBase(pfcand->trackRef(), trackPVs, iPV, PVweight);
   }
 }
 
 // -------------- setTracksSV ----------------
-template<>
-void BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::setTracksSV(const TrackRef & trackRef, const SVTagInfo * svTagInfo, int & isFromSV, int & iSV, float & SVweight)
-{
-  isFromSV = 0;
-  iSV = -1;
-  SVweight = 0.;
-
-  const reco::TrackBaseRef trackBaseRef( trackRef );
-
-  typedef reco::Vertex::trackRef_iterator IT;
-
-  size_t nSV = svTagInfo->nVertices();
-  for(size_t iv=0; iv<nSV; ++iv)
-  {
-    const reco::Vertex & vtx = svTagInfo->secondaryVertex(iv);
-    // loop over tracks in vertices
-    for(IT it=vtx.tracks_begin(); it!=vtx.tracks_end(); ++it)
-    {
-      const reco::TrackBaseRef & baseRef = *it;
-      // one of the tracks in the vertex is the same as the track considered in the function
-      if( baseRef == trackBaseRef )
-      {
-        float w = vtx.trackWeight(baseRef);
-        // select the vertex for which the track has the highest weight
-        if( w > SVweight )
-        {
-          SVweight = w;
-          isFromSV = 1;
-          iSV = iv;
-          break;
-        }
-      }
-    }
-  }
-}
-
-template<>
-void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::setTracksSV(const TrackRef & trackRef, const SVTagInfo * svTagInfo, int & isFromSV, int & iSV, float & SVweight)
+template<typename IPTI,typename VTX>
+void BTagAnalyzerLiteT<IPTI,VTX>::setTracksSV(const TrackRef & trackRef, const BTagAnalyzerLiteTrackVertexMap & trackSVs, int & isFromSV, int & iSV, float & SVweight) const
 {
-  isFromSV = 0;
-  iSV = -1;
-  SVweight = 0.;
-
-  typedef std::vector<reco::CandidatePtr>::const_iterator IT;
-
-  size_t nSV = svTagInfo->nVertices();
-  for(size_t iv=0; iv<nSV; ++iv)
-  {
-    const Vertex & vtx = svTagInfo->secondaryVertex(iv);
-    const std::vector<reco::CandidatePtr> & tracks = vtx.daughterPtrVector();
-
-    // one of the tracks in the vertex is the same as the track considered in the function
-    if( std::find(tracks.begin(),tracks.end(),trackRef) != tracks.end() )
-    {
-      SVweight = 1.;
-      isFromSV = 1;
-      iSV = iv;
-    }
-
-    // select the first vertex for which the track is used in the fit
-    // (reco::VertexCompositePtrCandidate does not store track weights so can't select the vertex for which the track has the highest weight)
-    if(iSV>=0)
-      break;
-  }
+  trackSVs.find(trackRef, iSV, SVweight);
+  isFromSV = ( iSV >= 0 ? 1 : 0 );
 }
 
 // -------------- vertexKinematicsAndChange ----------------
 template<>
-void BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::vertexKinematicsAndChange(const Vertex & vertex, reco::TrackKinematics & vertexKinematics, Int_t & charge)
+void BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::vertexKinematicsAndChange(const Vertex & vertex, reco::TrackKinematics & vertexKinematics, Int_t & charge) const
 {
   Bool_t hasRefittedTracks = vertex.hasRefittedTracks();
 
@@ -1614,7 +2600,7 @@ void BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::vertexKinematicsAndCh
 }
 
 template<>
-void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::vertexKinematicsAndChange(const Vertex & vertex, reco::TrackKinematics & vertexKinematics, Int_t & charge)
+void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::vertexKinematicsAndChange(const Vertex & vertex, reco::TrackKinematics & vertexKinematics, Int_t & charge) const
 {
   const std::vector<reco::CandidatePtr> & tracks = vertex.daughterPtrVector();
 
@@ -1627,33 +2613,31 @@ void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::v
 
 // -------------- recalcNsubjettiness ----------------
 template<>
-void BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::recalcNsubjettiness(const pat::Jet & jet, const SVTagInfo & svTagInfo, float & tau1, float & tau2)
+void BTagAnalyzerLiteT<reco::TrackIPTagInfo,reco::Vertex>::recalcNsubjettiness(const pat::Jet & jet, const SVTagInfo & svTagInfo, const BTagAnalyzerLiteTrackVertexMap & trackSVs,
+                                                                               fastjet::contrib::Njettiness & njettiness, float & tau1, float & tau2) const
 {
   // need candidate-based IVF vertices so do nothing here
 }
 
 template<>
-void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::recalcNsubjettiness(const pat::Jet & jet, const SVTagInfo & svTagInfo, float & tau1, float & tau2)
+void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::recalcNsubjettiness(const pat::Jet & jet, const SVTagInfo & svTagInfo, const BTagAnalyzerLiteTrackVertexMap & trackSVs,
+                                                                                                   fastjet::contrib::Njettiness & njettiness, float & tau1, float & tau2) const
 {
   std::vector<fastjet::PseudoJet> fjParticles;
-  std::vector<reco::CandidatePtr> svDaughters;
 
-  // loop over IVF vertices and push them in the vector of FastJet constituents and also collect their daughters
+  // loop over IVF vertices and push them in the vector of FastJet constituents
   for(size_t i=0; i<svTagInfo.nVertices(); ++i)
   {
     const reco::VertexCompositePtrCandidate & vtx = svTagInfo.secondaryVertex(i);
 
     fjParticles.push_back( fastjet::PseudoJet( vtx.px(), vtx.py(), vtx.pz(), vtx.energy() ) );
-
-    const std::vector<reco::CandidatePtr> & daughters = vtx.daughterPtrVector();
-    svDaughters.insert(svDaughters.end(), daughters.begin(), daughters.end());
   }
 
-  // loop over jet constituents and select those that are not daughters of IVF vertices
+  // loop over jet constituents and select those that are not daughters of IVF vertices (trackSVs holds the IVF vertex daughters)
   std::vector<reco::CandidatePtr> constituentsOther;
   for(const reco::CandidatePtr & daughter : jet.daughterPtrVector())
   {
-    if (std::find(svDaughters.begin(), svDaughters.end(), daughter) == svDaughters.end())
+    if ( !trackSVs.contains(daughter) )
       constituentsOther.push_back( daughter );
   }
 
@@ -1667,8 +2651,8 @@ void BTagAnalyzerLiteT<reco::CandIPTagInfo,reco::VertexCompositePtrCandidate>::r
   }
 
   // re-calculate N-subjettiness
-  tau1 = njettiness_.getTau(1, fjParticles);
-  tau2 = njettiness_.getTau(2, fjParticles);
+  tau1 = njettiness.getTau(1, fjParticles);
+  tau2 = njettiness.getTau(2, fjParticles);
 }
 
 
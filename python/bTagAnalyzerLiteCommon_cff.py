@@ -9,9 +9,57 @@ bTagAnalyzerLiteCommon = cms.PSet(
     storeMuonInfo            = cms.bool(False), ## True if you want to keep muon info
     storeTagVariables        = cms.bool(False), ## True if you want to keep TagInfo TaggingVariables
     storeCSVTagVariables     = cms.bool(True),  ## True if you want to keep CSV TaggingVariables
+    parallelJetProcessing    = cms.bool(False), ## True if you want the jets of an event to be processed in parallel tasks
+    asyncTreeFilling         = cms.bool(False), ## True if you want the output tree to be filled in a background thread
+    asyncTreeFillingQueueDepth = cms.uint32(2), ## maximum number of events waiting to be written by the background thread
+    branchSelection          = cms.vstring(), ## 'keep <pattern>'/'drop <pattern>' on the branch names, applied in order (e.g. 'drop *', 'keep Jet_pt')
+    branchPrecision          = cms.vstring(), ## '<pattern> <mantissa bits>' to store float branches with reduced precision (e.g. '*Track_eta 10')
+    outputFormat             = cms.string('TTree'), ## 'TTree' ('RNTuple' needs ROOT 6.26 or later)
+    splitTrees               = cms.bool(False), ## True if you want the jet, track, SV and tag variable columns in separate trees linked to ttree
+    splitTreesAutoFlush      = cms.PSet( ## TTree::SetAutoFlush setting of each tree with splitTrees (negative: bytes, positive: entries)
+        ttree      = cms.int64(-30000000),
+        jettree    = cms.int64(-30000000),
+        tracktree  = cms.int64(-30000000),
+        svtree     = cms.int64(-30000000),
+        tagvartree = cms.int64(-30000000)
+    ),
+    ioSettings               = cms.PSet( ## output tree I/O tuning ('' or -1 keep the ROOT defaults)
+        compressionAlgorithm = cms.string(''), ## 'ZLIB' or 'LZMA' ('LZ4' needs ROOT 6.06, 'ZSTD' ROOT 6.20)
+        compressionLevel     = cms.int32(-1),  ## 0-9
+        basketSize           = cms.int32(-1),  ## bytes
+        autoFlush            = cms.int64(-30000000), ## TTree::SetAutoFlush (negative: bytes, positive: entries)
+        autoSave             = cms.int64(-300000000), ## TTree::SetAutoSave (negative: bytes, positive: entries)
+        groups               = cms.VPSet( ## overrides for the branches matching any of the patterns (the last matching group wins), e.g.
+            ## cms.PSet(name = cms.string('tracks'), branches = cms.vstring('*Track_*'),
+            ##          compressionAlgorithm = cms.string('LZMA'), compressionLevel = cms.int32(9), basketSize = cms.int32(-1))
+        )
+    ),
+    flatJetTree              = cms.PSet( ## tree with one entry per jet (e.g. for tagger training)
+        enabled         = cms.bool(False),
+        keys            = cms.vstring('Run', 'Evt', 'LumiBlock'), ## event information copied to every jet
+        branchSelection = cms.vstring(), ## 'keep <pattern>'/'drop <pattern>' on the jet and block columns
+        blocks          = cms.VPSet( ## per-jet entries stored as fixed-length, zero-padded arrays
+            cms.PSet(
+                counter = cms.string('nTrkTagVarCSV'),
+                first   = cms.string('Jet_nFirstTrkTagVarCSV'),
+                last    = cms.string('Jet_nLastTrkTagVarCSV'),
+                sortKey = cms.string('TagVarCSV_trackSip2dSig'), ## sorted in descending order, '' keeps the stored order
+                length  = cms.uint32(8)
+            ),
+            cms.PSet(
+                counter = cms.string('nSV'),
+                first   = cms.string('Jet_nFirstSV'),
+                last    = cms.string('Jet_nLastSV'),
+                sortKey = cms.string(''),
+                length  = cms.uint32(2)
+            )
+        )
+    ),
     MaxEta                   = cms.double(2.5),
     MinPt                    = cms.double(20.0),
     src                      = cms.InputTag('generator'),
+    genEventInfo             = cms.InputTag('generator'),
+    pileupInfo               = cms.InputTag('addPileupInfo'),
     Jets                     = cms.InputTag('selectedPatJets'),
     FatJets                  = cms.InputTag('selectedPatJets'),
     GroomedFatJets           = cms.InputTag('selectedPatJetsAK8PrunedPFPacked'),
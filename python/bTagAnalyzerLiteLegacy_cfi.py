@@ -18,33 +18,29 @@ bTagAnalyzerLiteLegacy = cms.EDAnalyzer("BTagAnalyzerLiteLegacy",
 
     trackCHPBJetTags    = cms.string('trackCountingHighPurBJetTags'),
     trackCNegHPBJetTags = cms.string('negativeTrackCountingHighPurJetTags'),
-
-    jetBPBJetTags    = cms.string('jetBProbabilityBJetTags'),
-    jetBPNegBJetTags = cms.string('negativeOnlyJetBProbabilityJetTags'),
-    jetBPPosBJetTags = cms.string('positiveOnlyJetBProbabilityJetTags'),
-
-    jetPBJetTags     = cms.string('jetProbabilityBJetTags'),
-    jetPNegBJetTags  = cms.string('negativeOnlyJetProbabilityJetTags'),
-    jetPPosBJetTags  = cms.string('positiveOnlyJetProbabilityJetTags'),
-
-    simpleSVHighPurBJetTags    = cms.string('simpleSecondaryVertexHighPurBJetTags'),
-    simpleSVNegHighPurBJetTags = cms.string('negativeSimpleSecondaryVertexHighPurBJetTags'),
-    simpleSVHighEffBJetTags    = cms.string('simpleSecondaryVertexHighEffBJetTags'),
-    simpleSVNegHighEffBJetTags = cms.string('negativeSimpleSecondaryVertexHighEffBJetTags'),
-
-    combinedSVBJetTags    = cms.string('combinedSecondaryVertexV2BJetTags'),
-    combinedSVPosBJetTags = cms.string('positiveCombinedSecondaryVertexV2BJetTags'),
-    combinedSVNegBJetTags = cms.string('negativeCombinedSecondaryVertexV2BJetTags'),
-
-    combinedIVFSVBJetTags    = cms.string('combinedInclusiveSecondaryVertexV2BJetTags'),
-    combinedIVFSVPosBJetTags = cms.string('positiveCombinedInclusiveSecondaryVertexV2BJetTags'),
-    combinedIVFSVNegBJetTags = cms.string('negativeCombinedInclusiveSecondaryVertexV2BJetTags'),
-
-    softPFMuonBJetTags        = cms.string('softPFMuonBJetTags'),
-    softPFMuonNegBJetTags     = cms.string('negativeSoftPFMuonBJetTags'),
-    softPFMuonPosBJetTags     = cms.string('positiveSoftPFMuonBJetTags'),
-
-    softPFElectronBJetTags    = cms.string('softPFElectronBJetTags'),
-    softPFElectronNegBJetTags = cms.string('negativeSoftPFElectronBJetTags'),
-    softPFElectronPosBJetTags = cms.string('positiveSoftPFElectronBJetTags')
+    # discriminators stored for each jet (pat::Jet::bDiscriminator label and output branch)
+    discriminators = cms.VPSet(
+        cms.PSet(label = cms.string('negativeOnlyJetProbabilityJetTags')                 , branch = cms.string('Jet_ProbaN')),
+        cms.PSet(label = cms.string('positiveOnlyJetProbabilityJetTags')                 , branch = cms.string('Jet_ProbaP')),
+        cms.PSet(label = cms.string('jetProbabilityBJetTags')                            , branch = cms.string('Jet_Proba')),
+        cms.PSet(label = cms.string('negativeOnlyJetBProbabilityJetTags')                , branch = cms.string('Jet_BprobN')),
+        cms.PSet(label = cms.string('positiveOnlyJetBProbabilityJetTags')                , branch = cms.string('Jet_BprobP')),
+        cms.PSet(label = cms.string('jetBProbabilityBJetTags')                           , branch = cms.string('Jet_Bprob')),
+        cms.PSet(label = cms.string('negativeSimpleSecondaryVertexHighEffBJetTags')      , branch = cms.string('Jet_SvxN')),
+        cms.PSet(label = cms.string('simpleSecondaryVertexHighEffBJetTags')              , branch = cms.string('Jet_Svx')),
+        cms.PSet(label = cms.string('negativeSimpleSecondaryVertexHighPurBJetTags')      , branch = cms.string('Jet_SvxNHP')),
+        cms.PSet(label = cms.string('simpleSecondaryVertexHighPurBJetTags')              , branch = cms.string('Jet_SvxHP')),
+        cms.PSet(label = cms.string('negativeCombinedSecondaryVertexV2BJetTags')         , branch = cms.string('Jet_CombSvxN')),
+        cms.PSet(label = cms.string('positiveCombinedSecondaryVertexV2BJetTags')         , branch = cms.string('Jet_CombSvxP')),
+        cms.PSet(label = cms.string('combinedSecondaryVertexV2BJetTags')                 , branch = cms.string('Jet_CombSvx')),
+        cms.PSet(label = cms.string('combinedInclusiveSecondaryVertexV2BJetTags')        , branch = cms.string('Jet_CombIVF')),
+        cms.PSet(label = cms.string('positiveCombinedInclusiveSecondaryVertexV2BJetTags'), branch = cms.string('Jet_CombIVF_P')),
+        cms.PSet(label = cms.string('negativeCombinedInclusiveSecondaryVertexV2BJetTags'), branch = cms.string('Jet_CombIVF_N')),
+        cms.PSet(label = cms.string('negativeSoftPFMuonBJetTags')                        , branch = cms.string('Jet_SoftMuN')),
+        cms.PSet(label = cms.string('positiveSoftPFMuonBJetTags')                        , branch = cms.string('Jet_SoftMuP')),
+        cms.PSet(label = cms.string('softPFMuonBJetTags')                                , branch = cms.string('Jet_SoftMu')),
+        cms.PSet(label = cms.string('negativeSoftPFElectronBJetTags')                    , branch = cms.string('Jet_SoftElN')),
+        cms.PSet(label = cms.string('positiveSoftPFElectronBJetTags')                    , branch = cms.string('Jet_SoftElP')),
+        cms.PSet(label = cms.string('softPFElectronBJetTags')                            , branch = cms.string('Jet_SoftEl'))
+    )
 )
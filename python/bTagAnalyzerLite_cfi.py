@@ -18,33 +18,29 @@ bTagAnalyzerLite = cms.EDAnalyzer("BTagAnalyzerLite",
 
     trackCHPBJetTags    = cms.string('pfTrackCountingHighPurBJetTags'),
     trackCNegHPBJetTags = cms.string('pfNegativeTrackCountingHighPurJetTags'),
-
-    jetBPBJetTags    = cms.string('pfJetBProbabilityBJetTags'),
-    jetBPNegBJetTags = cms.string('pfNegativeOnlyJetBProbabilityJetTags'),
-    jetBPPosBJetTags = cms.string('pfPositiveOnlyJetBProbabilityJetTags'),
-
-    jetPBJetTags     = cms.string('pfJetProbabilityBJetTags'),
-    jetPNegBJetTags  = cms.string('pfNegativeOnlyJetProbabilityJetTags'),
-    jetPPosBJetTags  = cms.string('pfPositiveOnlyJetProbabilityJetTags'),
-
-    simpleSVHighPurBJetTags    = cms.string('pfSimpleSecondaryVertexHighPurBJetTags'),
-    simpleSVNegHighPurBJetTags = cms.string('pfNegativeSimpleSecondaryVertexHighPurBJetTags'),
-    simpleSVHighEffBJetTags    = cms.string('pfSimpleSecondaryVertexHighEffBJetTags'),
-    simpleSVNegHighEffBJetTags = cms.string('pfNegativeSimpleSecondaryVertexHighEffBJetTags'),
-
-    combinedSVBJetTags    = cms.string('pfCombinedSecondaryVertexV2BJetTags'),
-    combinedSVPosBJetTags = cms.string('pfPositiveCombinedSecondaryVertexV2BJetTags'),
-    combinedSVNegBJetTags = cms.string('pfNegativeCombinedSecondaryVertexV2BJetTags'),
-
-    combinedIVFSVBJetTags    = cms.string('pfCombinedInclusiveSecondaryVertexV2BJetTags'),
-    combinedIVFSVPosBJetTags = cms.string('pfPositiveCombinedInclusiveSecondaryVertexV2BJetTags'),
-    combinedIVFSVNegBJetTags = cms.string('pfNegativeCombinedInclusiveSecondaryVertexV2BJetTags'),
-
-    softPFMuonBJetTags        = cms.string('softPFMuonBJetTags'),
-    softPFMuonNegBJetTags     = cms.string('negativeSoftPFMuonBJetTags'),
-    softPFMuonPosBJetTags     = cms.string('positiveSoftPFMuonBJetTags'),
-
-    softPFElectronBJetTags    = cms.string('softPFElectronBJetTags'),
-    softPFElectronNegBJetTags = cms.string('negativeSoftPFElectronBJetTags'),
-    softPFElectronPosBJetTags = cms.string('positiveSoftPFElectronBJetTags')
+    # discriminators stored for each jet (pat::Jet::bDiscriminator label and output branch)
+    discriminators = cms.VPSet(
+        cms.PSet(label = cms.string('pfNegativeOnlyJetProbabilityJetTags')                 , branch = cms.string('Jet_ProbaN')),
+        cms.PSet(label = cms.string('pfPositiveOnlyJetProbabilityJetTags')                 , branch = cms.string('Jet_ProbaP')),
+        cms.PSet(label = cms.string('pfJetProbabilityBJetTags')                            , branch = cms.string('Jet_Proba')),
+        cms.PSet(label = cms.string('pfNegativeOnlyJetBProbabilityJetTags')                , branch = cms.string('Jet_BprobN')),
+        cms.PSet(label = cms.string('pfPositiveOnlyJetBProbabilityJetTags')                , branch = cms.string('Jet_BprobP')),
+        cms.PSet(label = cms.string('pfJetBProbabilityBJetTags')                           , branch = cms.string('Jet_Bprob')),
+        cms.PSet(label = cms.string('pfNegativeSimpleSecondaryVertexHighEffBJetTags')      , branch = cms.string('Jet_SvxN')),
+        cms.PSet(label = cms.string('pfSimpleSecondaryVertexHighEffBJetTags')              , branch = cms.string('Jet_Svx')),
+        cms.PSet(label = cms.string('pfNegativeSimpleSecondaryVertexHighPurBJetTags')      , branch = cms.string('Jet_SvxNHP')),
+        cms.PSet(label = cms.string('pfSimpleSecondaryVertexHighPurBJetTags')              , branch = cms.string('Jet_SvxHP')),
+        cms.PSet(label = cms.string('pfNegativeCombinedSecondaryVertexV2BJetTags')         , branch = cms.string('Jet_CombSvxN')),
+        cms.PSet(label = cms.string('pfPositiveCombinedSecondaryVertexV2BJetTags')         , branch = cms.string('Jet_CombSvxP')),
+        cms.PSet(label = cms.string('pfCombinedSecondaryVertexV2BJetTags')                 , branch = cms.string('Jet_CombSvx')),
+        cms.PSet(label = cms.string('pfCombinedInclusiveSecondaryVertexV2BJetTags')        , branch = cms.string('Jet_CombIVF')),
+        cms.PSet(label = cms.string('pfPositiveCombinedInclusiveSecondaryVertexV2BJetTags'), branch = cms.string('Jet_CombIVF_P')),
+        cms.PSet(label = cms.string('pfNegativeCombinedInclusiveSecondaryVertexV2BJetTags'), branch = cms.string('Jet_CombIVF_N')),
+        cms.PSet(label = cms.string('negativeSoftPFMuonBJetTags')                          , branch = cms.string('Jet_SoftMuN')),
+        cms.PSet(label = cms.string('positiveSoftPFMuonBJetTags')                          , branch = cms.string('Jet_SoftMuP')),
+        cms.PSet(label = cms.string('softPFMuonBJetTags')                                  , branch = cms.string('Jet_SoftMu')),
+        cms.PSet(label = cms.string('negativeSoftPFElectronBJetTags')                      , branch = cms.string('Jet_SoftElN')),
+        cms.PSet(label = cms.string('positiveSoftPFElectronBJetTags')                      , branch = cms.string('Jet_SoftElP')),
+        cms.PSet(label = cms.string('softPFElectronBJetTags')                              , branch = cms.string('Jet_SoftEl'))
+    )
 )